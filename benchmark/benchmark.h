@@ -0,0 +1,76 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glGPGPU.h>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <functional>
+
+// an invisible window is enough to own a context for compute
+GLFWwindow * benchmarkContext(int major = 3, int minor = 3)
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow * glfwWindow = glfwCreateWindow(1,1,"glGPGPU benchmark",NULL,NULL);
+    if (glfwWindow == NULL)
+    {
+        throw std::runtime_error("benchmark: could not create a GL "+std::to_string(major)+"."+std::to_string(minor)+" context");
+    }
+    glfwMakeContextCurrent(glfwWindow);
+    glewExperimental = GL_TRUE;
+    glewInit();
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << "\n";
+    return glfwWindow;
+}
+
+// mean wall time of f in milliseconds over repeats, after one warm up call
+//  setup runs untimed before every call of f
+double benchmarkMillis(std::function<void()> f, unsigned repeats, std::function<void()> setup = [](){})
+{
+    setup();
+    f();
+    double total = 0.0;
+    for (unsigned r = 0; r < repeats; r++)
+    {
+        setup();
+        auto tic = std::chrono::high_resolution_clock::now();
+        f();
+        auto toc = std::chrono::high_resolution_clock::now();
+        total += std::chrono::duration<double, std::milli>(toc-tic).count();
+    }
+    return total/double(repeats);
+}
+
+// fewer repeats for bigger problems, so each size takes similar time
+unsigned benchmarkRepeats(uint64_t elements)
+{
+    return std::max(uint64_t(4), uint64_t(1 << 22)/std::max(elements, uint64_t(1)));
+}
+
+void benchmarkRow(std::vector<std::string> cells, unsigned width = 16)
+{
+    for (const auto & cell : cells)
+    {
+        std::cout << std::setw(width) << cell;
+    }
+    std::cout << "\n";
+}
+
+std::string benchmarkFormat(double value, int precision = 3)
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(precision) << value;
+    return ss.str();
+}
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,103 @@
+#include "benchmark.h"
+
+#include <memory>
+
+/*
+    Constructing count glComputes of one fragment source, in
+     milliseconds, with the program cache disabled (every instance
+     compiles and links), disabled but loading a stored program binary
+     (every instance loads, as each new process would) and enabled (the
+     first instance links).
+
+    Then count distinct kernels constructed and waited on one after
+     another, and all constructed with deferCompile before waiting on
+     any, so the driver may compile them in parallel.
+*/
+
+const char * shader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D a;\n"
+    "uniform float scale;\n"
+    "void main(){\n"
+    "    o_value = texture(a, o_texCoords).r*scale;\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"count", "uncached", "binary", "cached", "speed up"});
+
+    for (uint64_t count = 1; count <= 256; count *= 4)
+    {
+        std::vector<std::unique_ptr<glCompute>> computes;
+        auto construct = [&computes, count]()
+        {
+            for (uint64_t i = 0; i < count; i++)
+            {
+                computes.push_back(std::make_unique<glCompute>(std::map<std::string, std::pair<uint64_t, uint64_t>>{{"a", {64, 64}}}, std::pair<uint64_t, uint64_t>{64, 64}, shader));
+            }
+            glFinish();
+        };
+        auto clear = [&computes]() { computes.clear(); };
+
+        glProgramCacheEnabled() = false;
+        double uncached = benchmarkMillis(construct, 2, clear);
+        glProgramBinaryDirectory() = "glGPGPU-benchmark-programs";
+        double binary = benchmarkMillis(construct, 2, clear);
+        glProgramBinaryDirectory() = "";
+        glProgramCacheEnabled() = true;
+        double cached = benchmarkMillis(construct, 2, clear);
+        computes.clear();
+
+        benchmarkRow({std::to_string(count), benchmarkFormat(uncached), benchmarkFormat(binary), benchmarkFormat(cached), benchmarkFormat(uncached/cached, 2)});
+    }
+
+    std::cout << "ms\n\n";
+
+    benchmarkRow({"kernels", "blocking", "deferred", "speed up"});
+
+    glProgramCacheEnabled() = false;
+    for (uint64_t count = 10; count <= 40; count += 10)
+    {
+        std::vector<std::string> sources;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            std::string source = shader;
+            source.replace(source.find("*scale"), 6, "*scale+"+std::to_string(i)+".0");
+            sources.push_back(source);
+        }
+
+        std::vector<std::unique_ptr<glCompute>> computes;
+        auto construct = [&computes, &sources](bool defer)
+        {
+            glCompute::Options options;
+            options.deferCompile = defer;
+            for (const auto & source : sources)
+            {
+                computes.push_back(std::make_unique<glCompute>(std::map<std::string, std::pair<uint64_t, uint64_t>>{{"a", {64, 64}}}, std::pair<uint64_t, uint64_t>{64, 64}, source.c_str(), options));
+            }
+            for (auto & compute : computes)
+            {
+                compute->wait();
+            }
+            glFinish();
+        };
+        auto clear = [&computes]() { computes.clear(); };
+
+        double blocking = benchmarkMillis([&construct]() { construct(false); }, 2, clear);
+        double deferred = benchmarkMillis([&construct]() { construct(true); }, 2, clear);
+        computes.clear();
+
+        benchmarkRow({std::to_string(count), benchmarkFormat(blocking), benchmarkFormat(deferred), benchmarkFormat(blocking/deferred, 2)});
+    }
+    glProgramCacheEnabled() = true;
+
+    std::cout << "ms\n";
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
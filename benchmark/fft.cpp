@@ -0,0 +1,125 @@
+#include "benchmark.h"
+
+#include <cmath>
+#include <complex>
+
+/*
+    2D complex FFTs of n x n values, in milliseconds.
+
+    "gpu" transforms a texture already on the gpu (glFinish included),
+     "gpu + transfers" also uploads and reads back the host data. "cpu"
+     is a single threaded iterative radix-2 FFT over rows then columns,
+     which is also the reference for the largest relative error.
+*/
+
+typedef std::complex<float> complex;
+
+// in place radix-2 FFT of n values stride apart
+void cpuFFT(complex * x, uint64_t n, uint64_t stride)
+{
+    for (uint64_t i = 1, j = 0; i < n; i++)
+    {
+        uint64_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            std::swap(x[i*stride], x[j*stride]);
+        }
+    }
+    for (uint64_t length = 2; length <= n; length *= 2)
+    {
+        double angle = -2.0*std::acos(-1.0)/double(length);
+        complex step(float(std::cos(angle)), float(std::sin(angle)));
+        for (uint64_t i = 0; i < n; i += length)
+        {
+            complex w(1.0f, 0.0f);
+            for (uint64_t k = 0; k < length/2; k++)
+            {
+                complex u = x[(i+k)*stride];
+                complex v = x[(i+k+length/2)*stride]*w;
+                x[(i+k)*stride] = u+v;
+                x[(i+k+length/2)*stride] = u-v;
+                w *= step;
+            }
+        }
+    }
+}
+
+void cpuFFT2D(std::vector<complex> & x, uint64_t n)
+{
+    for (uint64_t row = 0; row < n; row++)
+    {
+        cpuFFT(x.data()+row*n, n, 1);
+    }
+    for (uint64_t column = 0; column < n; column++)
+    {
+        cpuFFT(x.data()+column, n, n);
+    }
+}
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"size", "gpu", "gpu + transfers", "cpu", "error"});
+
+    glFFT fft;
+
+    for (uint64_t n = 64; n <= 4096; n *= 2)
+    {
+        unsigned repeats = n >= 2048 ? 1 : benchmarkRepeats(n*n);
+
+        std::vector<float> x(2*n*n);
+        for (uint64_t i = 0; i < n*n; i++)
+        {
+            x[2*i] = float(std::sin(0.37*double(i % 1021)));
+            x[2*i+1] = float(std::cos(1.1*double(i % 733)));
+        }
+
+        GLuint texture;
+        glGenTextures(1, &texture);
+        initTexture2D(texture, n, n, glFormat::RG32F);
+        transferToTexture2D(texture, x.data(), n, n, glFormat::RG32F);
+        double gpuMillis = benchmarkMillis([&fft, texture, n](){ fft.transform2D(texture, n, n); glFinish(); }, repeats);
+        glDeleteTextures(1, &texture);
+
+        std::vector<float> y;
+        double transferMillis = benchmarkMillis([&fft, &y, n](){ fft.transform2D(y, n, n); }, repeats, [&y, &x](){ y = x; });
+
+        std::vector<complex> c;
+        auto setup = [&c, &x, n]()
+        {
+            c.resize(n*n);
+            for (uint64_t i = 0; i < n*n; i++)
+            {
+                c[i] = complex(x[2*i], x[2*i+1]);
+            }
+        };
+        double cpuMillis = benchmarkMillis([&c, n](){ cpuFFT2D(c, n); }, repeats, setup);
+
+        double error = 0.0, scale = 0.0;
+        for (uint64_t i = 0; i < n*n; i++)
+        {
+            error = std::max(error, double(std::abs(complex(y[2*i], y[2*i+1])-c[i])));
+            scale = std::max(scale, double(std::abs(c[i])));
+        }
+
+        benchmarkRow
+        ({
+            std::to_string(n)+"x"+std::to_string(n),
+            benchmarkFormat(gpuMillis),
+            benchmarkFormat(transferMillis),
+            benchmarkFormat(cpuMillis),
+            benchmarkFormat(error/scale, 8)
+        });
+    }
+
+    std::cout << "ms\n";
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,105 @@
+#include "benchmark.h"
+
+/*
+    C = A B for square n x n matrices, in GFLOP/s, with data already on
+     the gpu (glFinish included, no transfers).
+
+    "naive" is one glCompute fragment per element of C looping over K
+     with texture(). The glGemm columns sweep its output block (1x4, 2x4
+     or 4x4 elements per fragment, one render target per block row) and
+     K unroll (texels of K per loop iteration), the fastest picks
+     glGemm's defaults.
+*/
+
+const char * naiveShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D a;\n"
+    "uniform highp sampler2D b;\n"
+    "uniform int n;\n"
+    "void main(){\n"
+    "    float sum = 0.0;\n"
+    "    for (int k = 0; k < n; k++){\n"
+    "        sum += texture(a, vec2((float(k)+0.5)/float(n), o_texCoords.y)).r\n"
+    "             * texture(b, vec2(o_texCoords.x, (float(k)+0.5)/float(n))).r;\n"
+    "    }\n"
+    "    o_value = sum;\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    const std::vector<unsigned> blockRows = {1, 2, 4};
+    const std::vector<unsigned> unrolls = {1, 2, 4};
+
+    std::vector<std::string> header = {"size", "naive"};
+    for (unsigned rows : blockRows)
+    {
+        for (unsigned unroll : unrolls)
+        {
+            header.push_back(std::to_string(rows)+"x4 unroll "+std::to_string(unroll));
+        }
+    }
+    benchmarkRow(header, 18);
+
+    for (uint64_t n = 128; n <= 1024; n *= 2)
+    {
+        double flops = 2.0*n*n*n;
+        unsigned repeats = std::max(2u, benchmarkRepeats(n*n*n/64));
+
+        std::vector<float> a(n*n), b(n*n);
+        for (uint64_t i = 0; i < n*n; i++)
+        {
+            a[i] = float(i % 7);
+            b[i] = float(i % 5);
+        }
+
+        glCompute naive({{"a", {n, n}}, {"b", {n, n}}}, {n, n}, naiveShader);
+        naive.set("a", a);
+        naive.set("b", b);
+        naive.sync();
+        naive.shader.setUniform("n", int(n));
+        double naiveMillis = benchmarkMillis([&naive](){ naive.compute(false); glFinish(); }, repeats);
+
+        std::vector<std::string> row = {std::to_string(n)+"x"+std::to_string(n), benchmarkFormat(flops/naiveMillis*1e-6, 2)};
+
+        for (unsigned rows : blockRows)
+        {
+            for (unsigned unroll : unrolls)
+            {
+                glGemm gemm(unroll, rows);
+                GLuint textures[3];
+                glGenTextures(3, textures);
+                for (GLuint t : textures)
+                {
+                    initTexture2D(t, n/4, n, glFormat::RGBA32F);
+                }
+                transferToTexture2D(textures[0], a.data(), n/4, n, glFormat::RGBA32F);
+                transferToTexture2D(textures[1], b.data(), n/4, n, glFormat::RGBA32F);
+
+                double millis = benchmarkMillis
+                (
+                    [&gemm, &textures, n]()
+                    {
+                        gemm.multiply(n, n, n, 1.0f, textures[0], textures[1], 0.0f, textures[2]);
+                        glFinish();
+                    },
+                    repeats
+                );
+                row.push_back(benchmarkFormat(flops/millis*1e-6, 2));
+                glDeleteTextures(3, textures);
+            }
+        }
+
+        benchmarkRow(row, 18);
+    }
+
+    std::cout << "GFLOP/s\n";
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
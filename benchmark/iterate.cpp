@@ -0,0 +1,94 @@
+#include "benchmark.h"
+
+/*
+    Explicit heat equation steps, feeding each output back as the input
+     either through the host (compute(true), result(), set(), sync())
+     or on the gpu with iterate().
+
+    Times are per step in milliseconds, including a final glFinish.
+*/
+
+const char * heatShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D u;\n"
+    "void main(){\n"
+    "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+    "    ivec2 n = textureSize(u, 0)-1;\n"
+    "    float c = texelFetch(u, p, 0).r;\n"
+    "    float l = texelFetch(u, clamp(p-ivec2(1, 0), ivec2(0), n), 0).r;\n"
+    "    float r = texelFetch(u, clamp(p+ivec2(1, 0), ivec2(0), n), 0).r;\n"
+    "    float d = texelFetch(u, clamp(p-ivec2(0, 1), ivec2(0), n), 0).r;\n"
+    "    float t = texelFetch(u, clamp(p+ivec2(0, 1), ivec2(0), n), 0).r;\n"
+    "    o_value = c+0.2*(l+r+d+t-4.0*c);\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"size", "steps", "host (ms)", "iterate (ms)", "speedup"});
+
+    const uint64_t steps = 32;
+
+    for (uint64_t n = 64; n <= 2048; n *= 2)
+    {
+        glCompute compute({{"u", {n, n}}}, {n, n}, heatShader);
+
+        std::vector<float> u(n*n, 0.0f);
+        u[n*n/2+n/2] = 1.0f;
+
+        auto reset = [&compute, &u]()
+        {
+            compute.set("u", u);
+            compute.sync();
+        };
+
+        unsigned repeats = std::max(1u, benchmarkRepeats(n*n*steps)/4);
+
+        double host = benchmarkMillis
+        (
+            [&compute]()
+            {
+                for (uint64_t s = 0; s < steps; s++)
+                {
+                    compute.compute(true);
+                    auto result = compute.result();
+                    compute.set("u", result.data(), result.size());
+                    compute.sync();
+                }
+                glFinish();
+            },
+            repeats,
+            reset
+        );
+
+        double gpu = benchmarkMillis
+        (
+            [&compute]()
+            {
+                compute.iterate("u", steps);
+                glFinish();
+            },
+            repeats,
+            reset
+        );
+
+        benchmarkRow
+        (
+            {
+                std::to_string(n)+"x"+std::to_string(n),
+                std::to_string(steps),
+                benchmarkFormat(host/steps),
+                benchmarkFormat(gpu/steps),
+                benchmarkFormat(host/gpu, 1)+"x"
+            }
+        );
+    }
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+
+/*
+    Sums a glCompute output on the gpu with reduce() against reading it
+     back with syncResult() and summing on the cpu.
+
+    Times are in milliseconds, the output is already computed.
+*/
+
+const char * computeShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D x;\n"
+    "void main(){\n"
+    "    o_value = texture(x, o_texCoords).r;\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"size", "readback (ms)", "reduce (ms)", "speedup"});
+
+    for (uint64_t n = 64; n <= 4096; n *= 2)
+    {
+        glCompute compute({{"x", {n, n}}}, {n, n}, computeShader);
+
+        std::vector<float> x(n*n);
+        for (uint64_t i = 0; i < n*n; i++)
+        {
+            x[i] = float(i % 17);
+        }
+        compute.set("x", x);
+        compute.sync();
+        compute.compute(false);
+
+        unsigned repeats = benchmarkRepeats(n*n);
+
+        float cpuSum = 0.0f;
+        double readback = benchmarkMillis
+        (
+            [&compute, &cpuSum]()
+            {
+                cpuSum = 0.0f;
+                for (float v : compute.syncResult())
+                {
+                    cpuSum += v;
+                }
+            },
+            repeats
+        );
+
+        float gpuSum = 0.0f;
+        double reduce = benchmarkMillis
+        (
+            [&compute, &gpuSum]()
+            {
+                gpuSum = compute.reduce(glReduction::Sum);
+            },
+            repeats
+        );
+
+        benchmarkRow
+        (
+            {
+                std::to_string(n)+"x"+std::to_string(n),
+                benchmarkFormat(readback),
+                benchmarkFormat(reduce),
+                benchmarkFormat(readback/reduce, 1)+"x"
+            }
+        );
+    }
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+
+#include <numeric>
+
+/*
+    Inclusive prefix sum of an n x n glCompute output with scan(), 1D
+     (row by row order) and within rows, against a single threaded
+     std::partial_sum over the same elements on the host.
+
+    gpu times include a glFinish but no readback.
+*/
+
+const char * computeShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D x;\n"
+    "void main(){\n"
+    "    o_value = texture(x, o_texCoords).r;\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"size", "layout", "cpu (ms)", "gpu (ms)", "speedup"});
+
+    for (uint64_t n = 64; n <= 2048; n *= 2)
+    {
+        glCompute compute({{"x", {n, n}}}, {n, n}, computeShader);
+
+        std::vector<float> x(n*n);
+        for (uint64_t i = 0; i < n*n; i++)
+        {
+            x[i] = float(i % 3);
+        }
+        compute.set("x", x);
+        compute.sync();
+
+        unsigned repeats = benchmarkRepeats(n*n);
+        std::vector<float> y(n*n);
+
+        for (bool rows : {false, true})
+        {
+            double cpu = benchmarkMillis
+            (
+                [&x, &y, n, rows]()
+                {
+                    if (rows)
+                    {
+                        for (uint64_t r = 0; r < n; r++)
+                        {
+                            std::partial_sum(x.begin()+r*n, x.begin()+(r+1)*n, y.begin()+r*n);
+                        }
+                    }
+                    else
+                    {
+                        std::partial_sum(x.begin(), x.end(), y.begin());
+                    }
+                },
+                repeats
+            );
+
+            double gpu = benchmarkMillis
+            (
+                [&compute, rows]()
+                {
+                    compute.scan(true, rows);
+                    glFinish();
+                },
+                repeats,
+                [&compute]()
+                {
+                    compute.compute(false);
+                    glFinish();
+                }
+            );
+
+            benchmarkRow
+            (
+                {
+                    std::to_string(n)+"x"+std::to_string(n),
+                    rows ? "rows" : "1D",
+                    benchmarkFormat(cpu),
+                    benchmarkFormat(gpu),
+                    benchmarkFormat(cpu/gpu, 1)+"x"
+                }
+            );
+        }
+    }
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,118 @@
+#include "benchmark.h"
+
+#include <cmath>
+
+/*
+    256 bin histograms and scatter-adds (reduce by key into 4096 keys)
+     of n values, in milliseconds.
+
+    "gpu" scatters textures already on the gpu (glFinish included),
+     "cpu" is a single threaded loop over host data. The gpu histogram
+     of a glCompute output otherwise has to read the whole output back.
+*/
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    const uint64_t bins = 256, keys = 4096;
+
+    benchmarkRow({"n", "histogram gpu", "histogram cpu", "scatter gpu", "scatter cpu"});
+
+    glScatter scatter;
+
+    for (uint64_t n = 1 << 16; n <= (1 << 22); n *= 4)
+    {
+        unsigned repeats = benchmarkRepeats(n);
+
+        std::vector<float> x(n);
+        std::vector<uint32_t> k(n);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            x[i] = float(std::sin(0.37*double(i)));
+            k[i] = uint32_t((i*2654435761u) % keys);
+        }
+
+        auto in = linearLayout(n);
+        auto out = linearLayout(keys);
+        std::vector<float> padded(x);
+        std::vector<uint32_t> paddedKeys(k);
+        padded.resize(in.first*in.second, 0.0f);
+        paddedKeys.resize(in.first*in.second, 0);
+
+        GLuint textures[3];
+        glGenTextures(3, textures);
+        initTexture2D(textures[0], in.first, in.second, glFormat::R32F);
+        initTexture2D(textures[1], in.first, in.second, glFormat::R32UI);
+        initTexture2D(textures[2], out.first, out.second, glFormat::R32F);
+        transferToTexture2D(textures[0], padded.data(), in.first, in.second, glFormat::R32F);
+        transferToTexture2D(textures[1], paddedKeys.data(), in.first, in.second, glFormat::R32UI);
+
+        double histogramGpu = benchmarkMillis
+        (
+            [&]()
+            {
+                scatter.histogram(textures[0], in.first, n, -1.0f, 1.0f, bins, textures[2], out.first, out.second);
+                glFinish();
+            },
+            repeats
+        );
+
+        std::vector<float> counts(bins);
+        double histogramCpu = benchmarkMillis
+        (
+            [&]()
+            {
+                std::fill(counts.begin(), counts.end(), 0.0f);
+                for (float v : x)
+                {
+                    if (v >= -1.0f && v < 1.0f)
+                    {
+                        counts[std::min(uint64_t((v+1.0f)*0.5f*float(bins)), bins-1)] += 1.0f;
+                    }
+                }
+            },
+            repeats
+        );
+
+        double scatterGpu = benchmarkMillis
+        (
+            [&]()
+            {
+                scatter.scatter(textures[1], textures[0], in.first, n, textures[2], out.first, out.second);
+                glFinish();
+            },
+            repeats
+        );
+
+        std::vector<float> sums(keys);
+        double scatterCpu = benchmarkMillis
+        (
+            [&]()
+            {
+                std::fill(sums.begin(), sums.end(), 0.0f);
+                for (uint64_t i = 0; i < n; i++)
+                {
+                    sums[k[i]] += x[i];
+                }
+            },
+            repeats
+        );
+
+        glDeleteTextures(3, textures);
+
+        benchmarkRow
+        ({
+            std::to_string(n),
+            benchmarkFormat(histogramGpu),
+            benchmarkFormat(histogramCpu),
+            benchmarkFormat(scatterGpu),
+            benchmarkFormat(scatterCpu)
+        });
+    }
+
+    std::cout << "ms\n";
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,112 @@
+#include "benchmark.h"
+
+/*
+    y = A x for the 5 point Poisson matrix of a k x k grid with
+     glSparseMatrix, against a single threaded CSR loop on the host.
+
+    "gpu" keeps x and y on the gpu (multiply() and a glFinish), "gpu+io"
+     uploads x and reads y back (multiply(x)).
+*/
+
+void poisson
+(
+    uint64_t k,
+    std::vector<uint32_t> & rowPointers,
+    std::vector<uint32_t> & columns,
+    std::vector<float> & values
+)
+{
+    rowPointers = {0};
+    columns.clear();
+    values.clear();
+    for (uint64_t y = 0; y < k; y++)
+    {
+        for (uint64_t x = 0; x < k; x++)
+        {
+            uint64_t i = y*k+x;
+            if (y > 0) { columns.push_back(i-k); values.push_back(-1.0f); }
+            if (x > 0) { columns.push_back(i-1); values.push_back(-1.0f); }
+            columns.push_back(i); values.push_back(4.0f);
+            if (x+1 < k) { columns.push_back(i+1); values.push_back(-1.0f); }
+            if (y+1 < k) { columns.push_back(i+k); values.push_back(-1.0f); }
+            rowPointers.push_back(columns.size());
+        }
+    }
+}
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"grid", "non-zeros", "cpu (ms)", "gpu (ms)", "gpu+io (ms)", "speedup"});
+
+    for (uint64_t k = 64; k <= 1024; k *= 2)
+    {
+        std::vector<uint32_t> rowPointers, columns;
+        std::vector<float> values;
+        poisson(k, rowPointers, columns, values);
+
+        uint64_t n = k*k;
+        glSparseMatrix matrix(n, n, rowPointers, columns, values);
+
+        std::vector<float> x(n), y(n);
+        for (uint64_t i = 0; i < n; i++)
+        {
+            x[i] = float(i % 13);
+        }
+        matrix.compute().set("x", x);
+
+        unsigned repeats = benchmarkRepeats(values.size());
+
+        double cpu = benchmarkMillis
+        (
+            [&]()
+            {
+                for (uint64_t i = 0; i < n; i++)
+                {
+                    float sum = 0.0f;
+                    for (uint32_t j = rowPointers[i]; j < rowPointers[i+1]; j++)
+                    {
+                        sum += values[j]*x[columns[j]];
+                    }
+                    y[i] = sum;
+                }
+            },
+            repeats
+        );
+
+        double gpu = benchmarkMillis
+        (
+            [&matrix]()
+            {
+                matrix.multiply();
+                glFinish();
+            },
+            repeats
+        );
+
+        double io = benchmarkMillis
+        (
+            [&matrix, &x]()
+            {
+                matrix.multiply(x);
+            },
+            repeats
+        );
+
+        benchmarkRow
+        (
+            {
+                std::to_string(k)+"x"+std::to_string(k),
+                std::to_string(values.size()),
+                benchmarkFormat(cpu),
+                benchmarkFormat(gpu),
+                benchmarkFormat(io),
+                benchmarkFormat(cpu/gpu, 1)+"x"
+            }
+        );
+    }
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
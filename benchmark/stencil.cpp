@@ -0,0 +1,72 @@
+#include "benchmark.h"
+
+#include <cmath>
+
+/*
+    k x k Gaussian stencils of a 1024 x 1024 R32F texture, in
+     milliseconds with data already on the gpu (glFinish included).
+
+    "2D" perturbs the centre weight so the kernel is no longer rank one
+     and glStencil samples all k*k weights, "separable" is the Gaussian
+     itself, run as a row pass then a column pass of k samples each.
+*/
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    const uint64_t n = 1024;
+
+    benchmarkRow({"kernel", "2D", "separable", "speed up"});
+
+    std::vector<float> x(n*n);
+    for (uint64_t i = 0; i < n*n; i++)
+    {
+        x[i] = float(i % 17);
+    }
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    for (GLuint t : textures)
+    {
+        initTexture2D(t, n, n, glFormat::R32F);
+    }
+    transferToTexture2D(textures[0], x.data(), n, n, glFormat::R32F);
+
+    for (uint64_t k = 3; k <= 31; k = 2*k+1)
+    {
+        std::vector<float> weights(k*k);
+        double sigma = double(k)/6.0;
+        for (uint64_t j = 0; j < k; j++)
+        {
+            for (uint64_t i = 0; i < k; i++)
+            {
+                double dx = double(i)-double(k/2), dy = double(j)-double(k/2);
+                weights[j*k+i] = float(std::exp(-(dx*dx+dy*dy)/(2.0*sigma*sigma)));
+            }
+        }
+        std::vector<float> perturbed = weights;
+        perturbed[(k/2)*k+k/2] += 0.5f;
+
+        glStencil full(perturbed, k, k);
+        glStencil separable(weights, k, k);
+
+        unsigned repeats = benchmarkRepeats(n*n*k/8);
+        double fullMillis = benchmarkMillis([&full, &textures, n](){ full.apply(textures[0], textures[1], n, n); glFinish(); }, repeats);
+        double separableMillis = benchmarkMillis([&separable, &textures, n](){ separable.apply(textures[0], textures[1], n, n); glFinish(); }, repeats);
+
+        benchmarkRow
+        ({
+            std::to_string(k)+"x"+std::to_string(k),
+            benchmarkFormat(fullMillis),
+            benchmarkFormat(separableMillis),
+            benchmarkFormat(fullMillis/separableMillis, 2)
+        });
+    }
+
+    glDeleteTextures(2, textures);
+
+    std::cout << "ms\n";
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -0,0 +1,111 @@
+#include "benchmark.h"
+
+/*
+    Compares glCompute::sync for the blocking path, the pixel unpack
+     buffer ring and persistently mapped staging, uploading the whole attribute ("full") or after
+     changing a contiguous 1% of its elements at a random offset
+     ("sparse").
+
+    "sync" is the cpu time spent inside sync(), "sync+finish" includes
+     waiting for the gpu to finish the copy. "allocs" counts gpu storage
+     allocations made while timing, which should be 0.
+*/
+
+const char * computeShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 o_texCoords;\n"
+    "layout(location=0) out float o_value;\n"
+    "uniform highp sampler2D x;\n"
+    "void main(){\n"
+    "    o_value = texture(x, o_texCoords).r;\n"
+    "}";
+
+int main()
+{
+    GLFWwindow * glfwWindow = benchmarkContext();
+
+    benchmarkRow({"size", "mode", "update", "sync (ms)", "sync+finish", "allocs"});
+
+    for (uint64_t n = 16; n <= 4096; n *= 2)
+    {
+        std::vector<std::pair<std::string, glCompute::Transfer>> transfers =
+        {
+            {"blocking", glCompute::Transfer::Blocking},
+            {"pixel buffer", glCompute::Transfer::PixelBuffer},
+            {"persistent", glCompute::Transfer::Persistent}
+        };
+
+        for (const auto & mode : transfers)
+        {
+            glCompute::Transfer transfer = mode.second;
+            glCompute compute
+            (
+                {
+                    {"x", {n, n}}
+                },
+                {1, 1},
+                computeShader,
+                transfer
+            );
+
+            std::vector<float> x(n*n);
+            for (uint64_t i = 0; i < n*n; i++)
+            {
+                x[i] = float(i);
+            }
+            compute.set("x", x);
+
+            unsigned repeats = benchmarkRepeats(n*n);
+
+            // get() hands out a mutable reference, marking everything dirty
+            auto full = [&compute]()
+            {
+                compute.get("x");
+            };
+
+            uint64_t seed = 1;
+            auto sparse = [&compute, &seed, n]()
+            {
+                uint64_t count = std::max(uint64_t(1), n*n/100);
+                seed = seed*6364136223846793005ULL+1442695040888963407ULL;
+                uint64_t offset = (seed >> 33) % (n*n-count);
+                for (uint64_t k = 0; k < count; k++)
+                {
+                    compute.set("x", float(k), offset+k);
+                }
+            };
+
+            std::vector<std::pair<std::string, std::function<void()>>> updates =
+            {
+                {"full", full},
+                {"sparse", sparse}
+            };
+
+            for (const auto & update : updates)
+            {
+                const std::function<void()> & change = update.second;
+                uint64_t allocations = glAllocations();
+                double sync = benchmarkMillis([&compute](){ compute.sync(); }, repeats, change);
+                glFinish();
+                double syncFinish = benchmarkMillis([&compute](){ compute.sync(); glFinish(); }, repeats, change);
+
+                benchmarkRow
+                (
+                    {
+                        std::to_string(n)+"x"+std::to_string(n),
+                        mode.first,
+                        update.first,
+                        benchmarkFormat(sync),
+                        benchmarkFormat(syncFinish),
+                        std::to_string(glAllocations()-allocations)
+                    }
+                );
+            }
+        }
+    }
+
+    glfwDestroyWindow(glfwWindow);
+    glfwTerminate();
+}
@@ -36,12 +36,25 @@ https://developer.android.com/ndk/guides/stable_apis
 #include <string>
 #include <vector>
 #include <map>
+#include <variant>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+#include <memory>
+#include <cstring>
+#include <cmath>
 #include <algorithm>
 #include <stdexcept>
 #include <regex>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/packing.hpp>
 #include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <random>
 
 class GLRuntimeException: public std::exception
 {
@@ -118,786 +131,5349 @@ GLuint glError(const std::string msg)
     return e;
 }
 
-// compile a gl shader given a program and source code as const char *
-void compileShader(GLuint & shaderProgram, const char * vert, const char * frag)
+/*
+    A program whose shaders are compiling and linking. Drivers may do
+     the work on other threads, and only block when a status is queried,
+     so submitShader issues the compile and link calls without queries
+     and finishShader checks them later. Submitting many programs before
+     finishing any lets their compiles overlap.
+*/
+struct glShaderJob
+{
+    GLuint program = 0;
+    GLuint vertex = 0;
+    GLuint fragment = 0;
+    // store the program binary under this key once linked, if not empty
+    std::string binaryKey = "";
+    // why it failed, thrown again to every later finishShader
+    std::string error = "";
+
+    bool pending() const { return vertex != 0; }
+};
+
+// start compiling and linking vert and frag into shaderProgram
+glShaderJob submitShader(GLuint shaderProgram, const char * vert, const char * frag)
+{
+    glShaderJob job;
+    job.program = shaderProgram;
+
+    job.vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(job.vertex,1,&vert,NULL);
+    glCompileShader(job.vertex);
+
+    job.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(job.fragment,1,&frag,NULL);
+    glCompileShader(job.fragment);
+
+    glAttachShader(shaderProgram,job.vertex);
+    glAttachShader(shaderProgram,job.fragment);
+    glLinkProgram(shaderProgram);
+
+    return job;
+}
+
+// drop job's shader objects, the program keeps its linked code
+void releaseShaderJob(glShaderJob & job)
+{
+    if (!job.pending())
+    {
+        return;
+    }
+    glDetachShader(job.program, job.vertex);
+    glDetachShader(job.program, job.fragment);
+    glDeleteShader(job.vertex);
+    glDeleteShader(job.fragment);
+    job.vertex = 0;
+    job.fragment = 0;
+}
+
+// wait for job and check it compiled and linked, vert and frag are for error messages
+void finishShader(glShaderJob & job, const char * vert, const char * frag)
 {
-    GLuint vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader,1,&vert,NULL);
-    glCompileShader(vertexShader);
+    if (!job.pending())
+    {
+        if (!job.error.empty())
+        {
+            throw( GLRuntimeException(job.error) );
+        }
+        return;
+    }
 
     // check it worked!
     int  success;
     const unsigned logSize = 512*4;
     char infoLog[logSize];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(job.vertex, GL_COMPILE_STATUS, &success);
 
     if(!success)
     {
-        glGetShaderInfoLog(vertexShader, logSize, NULL, infoLog);
-        throw( GLRuntimeException( std::string("GLSL (VERTEX) ERROR: \n") + infoLog + "\n"+vert+"\n") );
+        glGetShaderInfoLog(job.vertex, logSize, NULL, infoLog);
+        job.error = std::string("GLSL (VERTEX) ERROR: \n") + infoLog + "\n"+vert+"\n";
+        releaseShaderJob(job);
+        throw( GLRuntimeException(job.error) );
     }
 
-    GLuint fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader,1,&frag,NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(job.fragment, GL_COMPILE_STATUS, &success);
 
     if(!success)
     {
-        glGetShaderInfoLog(fragmentShader, logSize, NULL, infoLog);
-        throw( GLRuntimeException( std::string("GLSL (FRAGMENT) ERROR: \n") + infoLog +"\n"+frag+"\n") );
+        glGetShaderInfoLog(job.fragment, logSize, NULL, infoLog);
+        job.error = std::string("GLSL (FRAGMENT) ERROR: \n") + infoLog +"\n"+frag+"\n";
+        releaseShaderJob(job);
+        throw( GLRuntimeException(job.error) );
     }
 
-    glAttachShader(shaderProgram,vertexShader);
-    glAttachShader(shaderProgram,fragmentShader);
-    glLinkProgram(shaderProgram);
-
     // check it linked
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
     if(!success)
     {
-        glGetProgramInfoLog(shaderProgram, logSize, NULL, infoLog);
-        throw( GLRuntimeException( std::string("GLSL (LINK) ERROR: \n") + infoLog + "\n"+vert+"\n"+frag+"\n") );
+        glGetProgramInfoLog(job.program, logSize, NULL, infoLog);
+        job.error = std::string("GLSL (LINK) ERROR: \n") + infoLog + "\n"+vert+"\n"+frag+"\n";
+        releaseShaderJob(job);
+        throw( GLRuntimeException(job.error) );
     }
-    glGetProgramInfoLog(shaderProgram, logSize, NULL, infoLog);
+    releaseShaderJob(job);
 }
 
-void initTexture2DR32F(GLuint id, uint64_t n, uint64_t m)
+// compile a gl shader given a program and source code as const char *
+void compileShader(GLuint & shaderProgram, const char * vert, const char * frag)
 {
-    glBindTexture(GL_TEXTURE_2D,id);
-    glTexParameteri(
-        GL_TEXTURE_2D,
-        GL_TEXTURE_MIN_FILTER,
-        GL_NEAREST
-    );
-    glTexParameteri(
-        GL_TEXTURE_2D,
-        GL_TEXTURE_MAG_FILTER,
-        GL_NEAREST
-    );
-    glTexParameteri(
-        GL_TEXTURE_2D,
-        GL_TEXTURE_WRAP_S,
-        GL_CLAMP_TO_EDGE
-    );
-    glTexParameteri(
-        GL_TEXTURE_2D,
-        GL_TEXTURE_WRAP_T,
-        GL_CLAMP_TO_EDGE
-    );
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_R32F,
-        n,
-        m,
-        0,
-        GL_RED,
-        GL_FLOAT,
-        NULL
-    );
+    glShaderJob job = submitShader(shaderProgram, vert, frag);
+    finishShader(job, vert, frag);
 }
 
-void transferToTexture2DR32F(GLuint id, std::vector<float> data, uint64_t n, uint64_t m)
+bool glHasTextureStorage()
 {
-    glBindTexture(GL_TEXTURE_2D,id);
-
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        GL_R32F,
-        n,
-        m,
-        0,
-        GL_RED,
-        GL_FLOAT,
-        data.data()
-    );
+#ifdef ANDROID
+    return true;
+#else
+    return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+#endif
 }
 
-struct AbstractUniform
+bool glHasBufferStorage()
 {
-    AbstractUniform(std::string n)
-    : name(n)
-    {}
-
-    virtual ~AbstractUniform() = default;
-
-    std::string name;
-};
+#ifdef ANDROID
+    return false;
+#else
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+#endif
+}
 
-template <class T>
-struct Uniform : public AbstractUniform
+// the number of gpu storage allocations (texture and buffer storage
+//  specifications) glGPGPU has made, a steady state sync() loop leaves
+//  this unchanged
+uint64_t & glAllocations()
 {
-    Uniform(std::string n, T v)
-    : AbstractUniform(n), value(v)
-    {}
-
-    T value;
-};
-
-template <class T>
-const Uniform NULL_UNIFORM("", static_cast<T>(NAN));
+    static uint64_t allocations = 0;
+    return allocations;
+}
 
-struct Sampler2D {
+bool glHasParallelShaderCompile()
+{
+#ifdef ANDROID
+    return false;
+#else
+    return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+#endif
+}
 
-    Sampler2D(int t)
-    : texture(t)
-    {}
+// true when finishing job will not block. Without parallel compile
+//  support there is no way to ask, so a pending job reports ready and
+//  finishing it blocks, polling loops then end instead of spinning
+bool shaderReady(const glShaderJob & job)
+{
+    if (!job.pending())
+    {
+        return true;
+    }
+#ifndef ANDROID
+    if (glHasParallelShaderCompile())
+    {
+        GLint done = GL_FALSE;
+        glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+#endif
+    return true;
+}
 
-    Sampler2D(unsigned t)
-    : texture(t)
-    {}
+// let the driver compile on as many threads as it likes. The limit is
+//  context state, so it is set on every submit (a cheap call) rather than
+//  once, which would miss other contexts
+void enableParallelShaderCompile()
+{
+#ifndef ANDROID
+    if (!glHasParallelShaderCompile())
+    {
+        return;
+    }
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    else
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+#endif
+}
 
-    Sampler2D(float t)
-    : texture(int(t))
-    {}
+bool glHasProgramBinary()
+{
+#ifdef ANDROID
+    return true;
+#else
+    return GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+#endif
+}
 
-    int texture;
-};
+/*
+    Linked program binaries are stored in glProgramBinaryDirectory(), when
+     set, and loaded by later processes instead of compiling. A binary
+     is only valid for the driver that produced it, so the key is the
+     vertex and fragment source plus the GL vendor, renderer and version
+     strings. Files are named by the key's hash and begin with the key
+     itself, a file with another key (a collision) is ignored.
+
+    Drivers may still reject a binary (e.g. after an update that keeps
+     the version string), compileShaderCached then compiles and
+     overwrites it.
+*/
+std::string & glProgramBinaryDirectory()
+{
+    static std::string directory = "";
+    return directory;
+}
 
-template <class T>
-const std::regex UNIFORM_DATA_REGEX;
-
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<int> = std::regex("uniform int (\\S+);");
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<float> = std::regex("uniform float (\\S+);");
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<glm::vec2> = std::regex("uniform vec2 (\\S+);");
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<glm::vec4> = std::regex("uniform vec4 (\\S+);");
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<glm::mat4> = std::regex("uniform mat4 (\\S+);");
-template <> inline
-const std::regex UNIFORM_DATA_REGEX<Sampler2D> = std::regex("uniform(\\slowp\\s|\\shighp\\s|\\smediump\\s|\\s)sampler2D (\\S+);");
+std::string glProgramBinaryKey(const std::string & vert, const std::string & frag)
+{
+    auto str = [](GLenum name)
+    {
+        const GLubyte * s = glGetString(name);
+        return s == nullptr ? std::string("") : std::string(reinterpret_cast<const char*>(s));
+    };
+    return vert+'\0'+frag+'\0'+str(GL_VENDOR)+'\0'+str(GL_RENDERER)+'\0'+str(GL_VERSION);
+}
 
+std::filesystem::path glProgramBinaryPath(const std::string & key)
+{
+    std::stringstream name;
+    name << std::hex << std::hash<std::string>{}(key) << ".bin";
+    return std::filesystem::path(glProgramBinaryDirectory()) / name.str();
+}
 
-struct Shader
+// link program from a stored binary, false if there is none or the driver rejects it
+bool loadProgramBinary(GLuint program, const std::string & key)
 {
-    Shader(const char * v, const char * f)
-    : vertex(v), fragment(f)
+    std::ifstream file(glProgramBinaryPath(key), std::ios::binary);
+    if (!file.is_open())
     {
-        parseUniforms();
+        return false;
     }
 
-    Shader()
-    : vertex(""),fragment("")
-    {}
+    uint64_t keyLength = 0;
+    file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+    if (!file || keyLength != key.size())
+    {
+        return false;
+    }
+    std::string storedKey(keyLength, '\0');
+    file.read(storedKey.data(), keyLength);
+    if (!file || storedKey != key)
+    {
+        return false;
+    }
 
-    Shader(std::string path, std::string name)
+    GLenum format = 0;
+    uint64_t length = 0;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!file)
     {
-        std::ifstream fileVs(path+name+".vs");
-        std::ifstream fileFs(path+name+".fs");
-        if (fileVs.is_open() && fileFs.is_open())
-        {
-            vertex = parseShaderSource(fileVs);
-            fragment = parseShaderSource(fileFs);
-        }
-        else
-        {
-            throw std::runtime_error(" attempting to locate source files .vs and .fs at "+path+name);
-        }
+        return false;
+    }
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file)
+    {
+        return false;
+    }
 
-        parseUniforms();
+    // a format the driver does not list would raise GL_INVALID_ENUM,
+    //  anything else it rejects only fails GL_LINK_STATUS
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    std::vector<GLint> supported(std::max(formats, 0));
+    if (formats > 0)
+    {
+        glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, supported.data());
+    }
+    if (std::find(supported.begin(), supported.end(), GLint(format)) == supported.end())
+    {
+        return false;
     }
 
-    virtual ~Shader() = default;
+    glProgramBinary(program, format, binary.data(), GLsizei(length));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
 
-    bool operator==(const Shader & s)
+// write program's binary for key, other processes may be writing the same key
+void storeProgramBinary(GLuint program, const std::string & key)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
     {
-        return this->vertex == s.vertex && this->fragment == s.fragment;
+        return;
     }
-
-    template <class T>
-    void setUniform(std::string name, T value)
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(glProgramBinaryDirectory(), error);
+    std::filesystem::path path = glProgramBinaryPath(key);
+    // written whole then renamed, so readers never see a partial file
+    std::filesystem::path temporary = path;
+    temporary += "."+std::to_string(std::random_device{}());
     {
-        if (uniforms.find(name) == uniforms.end())
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
         {
-            throw std::runtime_error("could not find uniform: " + name);
+            return;
         }
-
-        AbstractUniform * uniform = uniforms[name].get();
-
-        if (dynamic_cast<Uniform<T>*>(uniform) == nullptr)
+        uint64_t keyLength = key.size();
+        uint64_t binaryLength = uint64_t(length);
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(key.data(), keyLength);
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&binaryLength), sizeof(binaryLength));
+        file.write(binary.data(), binaryLength);
+        if (!file)
         {
+            file.close();
+            std::filesystem::remove(temporary, error);
             return;
         }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+    }
+}
 
-        Uniform<T> * u = dynamic_cast<Uniform<T>*>(uniform);
-        if (u != nullptr){ setValue(u, value); return; }
+// submitShader, through the program binary directory when it is set. A
+//  loaded binary is linked already and gives a job with nothing pending
+glShaderJob submitShaderCached(GLuint & shaderProgram, const char * vert, const char * frag)
+{
+    enableParallelShaderCompile();
 
-        return;
+    if (glProgramBinaryDirectory().empty() || !glHasProgramBinary())
+    {
+        return submitShader(shaderProgram, vert, frag);
     }
 
-    const std::string & getVertex() const { return vertex; }
-    const std::string & getFragment() const { return fragment; }
+    std::string key = glProgramBinaryKey(vert, frag);
+    if (loadProgramBinary(shaderProgram, key))
+    {
+        glShaderJob job;
+        job.program = shaderProgram;
+        return job;
+    }
 
-    template <class T>
-    Uniform<T> getUniform(std::string name)
+    // a failed glProgramBinary leaves program unlinked, start afresh
+    glDeleteProgram(shaderProgram);
+    shaderProgram = glCreateProgram();
+    glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glShaderJob job = submitShader(shaderProgram, vert, frag);
+    job.binaryKey = key;
+    return job;
+}
+
+// finishShader, then store the program binary if job asks for it
+void finishShaderCached(glShaderJob & job, const char * vert, const char * frag)
+{
+    finishShader(job, vert, frag);
+    if (!job.binaryKey.empty())
     {
-        if (uniforms.find(name) == uniforms.end())
-        {
-            return NULL_UNIFORM<T>;
-        }
+        storeProgramBinary(job.program, job.binaryKey);
+        job.binaryKey = "";
+    }
+}
 
-        AbstractUniform * uniform = uniforms[name].get();
+// compileShader, through the program binary directory when it is set
+void compileShaderCached(GLuint & shaderProgram, const char * vert, const char * frag)
+{
+    glShaderJob job = submitShaderCached(shaderProgram, vert, frag);
+    finishShaderCached(job, vert, frag);
+}
 
-        if (dynamic_cast<Uniform<T>*>(uniform) == nullptr)
-        {
-            return NULL_UNIFORM<T>;
-        }
+/*
+    Texel formats for attributes and outputs, host data is held as the
+     matching element type
 
-        Uniform<T> * u = dynamic_cast<Uniform<T>*>(uniform);
-        if (u != nullptr){ return *u; }
+    R32F, RG32F, RGBA32F: float
+    R16F:                 uint16_t half floats, float data is converted
+    R32I:                 int32_t
+    R32UI, RG32UI:        uint32_t
 
-        return NULL_UNIFORM<T>;
-    }
+    Multi-channel data is interleaved, {r, g, r, g, ...} for RG32F.
+*/
+enum class glFormat {R32F, RG32F, RGBA32F, R16F, R32I, R32UI, RG32UI};
 
-    std::vector<std::string> getUniformNames()
+struct glFormatInfo
+{
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    uint8_t channels;
+    uint8_t channelBytes;
+    // glsl sampler and value types
+    const char * sampler;
+    const char * value;
+
+    uint64_t texelBytes() const { return uint64_t(channels)*channelBytes; }
+};
+
+glFormatInfo formatInfo(glFormat format)
+{
+    switch (format)
     {
-        std::vector<std::string> v;
-        for (auto it = uniforms.cbegin(); it != uniforms.cend(); it++)
-        {
-            v.push_back(it->first);
-        }
-        return v;
+        case glFormat::R32F:
+            return {GL_R32F, GL_RED, GL_FLOAT, 1, 4, "sampler2D", "float"};
+        case glFormat::RG32F:
+            return {GL_RG32F, GL_RG, GL_FLOAT, 2, 4, "sampler2D", "vec2"};
+        case glFormat::RGBA32F:
+            return {GL_RGBA32F, GL_RGBA, GL_FLOAT, 4, 4, "sampler2D", "vec4"};
+        case glFormat::R16F:
+            return {GL_R16F, GL_RED, GL_HALF_FLOAT, 1, 2, "sampler2D", "float"};
+        case glFormat::R32I:
+            return {GL_R32I, GL_RED_INTEGER, GL_INT, 1, 4, "isampler2D", "int"};
+        case glFormat::R32UI:
+            return {GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 1, 4, "usampler2D", "uint"};
+        case glFormat::RG32UI:
+            return {GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, 2, 4, "usampler2D", "uvec2"};
     }
+    throw std::runtime_error("formatInfo: unknown format");
+}
 
-    virtual void use() = 0;
-
-protected:
-
-    std::string vertex;
-    std::string fragment;
+// is T the host element type of format
+template <class T>
+bool isHostType(glFormat format)
+{
+    GLenum type = formatInfo(format).type;
+    return (std::is_same<T, float>::value && type == GL_FLOAT)
+        || (std::is_same<T, uint16_t>::value && type == GL_HALF_FLOAT)
+        || (std::is_same<T, int32_t>::value && type == GL_INT)
+        || (std::is_same<T, uint32_t>::value && type == GL_UNSIGNED_INT);
+}
 
-    std::unordered_map<std::string, std::shared_ptr<AbstractUniform>> uniforms;
+// host data for any format, one vector alternative per element type
+typedef std::variant
+<
+    std::vector<float>,
+    std::vector<uint16_t>,
+    std::vector<int32_t>,
+    std::vector<uint32_t>
+> HostVector;
 
-    std::string parseShaderSource(std::ifstream & file)
+HostVector makeHostVector(glFormat format, uint64_t elements)
+{
+    switch (formatInfo(format).type)
     {
-        std::string src = "";
-        std::string line;
-        while (std::getline(file,line))
-        {
-            src += line + "\n";
-        }
-        return src;
+        case GL_HALF_FLOAT:
+            return std::vector<uint16_t>(elements, 0);
+        case GL_INT:
+            return std::vector<int32_t>(elements, 0);
+        case GL_UNSIGNED_INT:
+            return std::vector<uint32_t>(elements, 0);
+        default:
+            return std::vector<float>(elements, 0.0f);
     }
+}
 
-    virtual void compile() = 0;
+void * hostData(HostVector & v)
+{
+    return std::visit([](auto & x) { return static_cast<void*>(x.data()); }, v);
+}
 
-    bool parseUniforms()
+// immutable storage where available so later uploads never reallocate
+void initTexture2D(GLuint id, uint64_t n, uint64_t m, glFormat format)
+{
+    glFormatInfo info = formatInfo(format);
+    glBindTexture(GL_TEXTURE_2D,id);
+    glTexParameteri(
+        GL_TEXTURE_2D,
+        GL_TEXTURE_MIN_FILTER,
+        GL_NEAREST
+    );
+    glTexParameteri(
+        GL_TEXTURE_2D,
+        GL_TEXTURE_MAG_FILTER,
+        GL_NEAREST
+    );
+    glTexParameteri(
+        GL_TEXTURE_2D,
+        GL_TEXTURE_WRAP_S,
+        GL_CLAMP_TO_EDGE
+    );
+    glTexParameteri(
+        GL_TEXTURE_2D,
+        GL_TEXTURE_WRAP_T,
+        GL_CLAMP_TO_EDGE
+    );
+    if (glHasTextureStorage())
+    {
+        glTexStorage2D(
+            GL_TEXTURE_2D,
+            1,
+            info.internalFormat,
+            n,
+            m
+        );
+    }
+    else
+    {
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            info.internalFormat,
+            n,
+            m,
+            0,
+            info.format,
+            info.type,
+            NULL
+        );
+    }
+    glAllocations()++;
+}
+
+/*
+    What texture() samples outside [0, 1), texelFetch ignores this
+
+    Clamp:    the nearest edge texel
+    Wrap:     periodic
+    Constant: a constant value, needs GL_CLAMP_TO_BORDER (not on ES 3.1)
+*/
+enum class glBoundary {Clamp, Wrap, Constant};
+
+GLenum boundaryWrap(glBoundary boundary)
+{
+    switch (boundary)
+    {
+        case glBoundary::Clamp:
+            return GL_CLAMP_TO_EDGE;
+        case glBoundary::Wrap:
+            return GL_REPEAT;
+        case glBoundary::Constant:
+#ifdef ANDROID
+            throw std::runtime_error("boundaryWrap: constant boundaries need GL_CLAMP_TO_BORDER");
+#else
+            return GL_CLAMP_TO_BORDER;
+#endif
+    }
+    throw std::runtime_error("boundaryWrap: unknown boundary");
+}
+
+// replace initTexture2D's clamped boundary, for neighbour sampling with
+//  texture() in glCompute shaders
+void setTextureBoundary2D(GLuint id, glBoundary boundary, float constant = 0.0f)
+{
+    GLenum wrap = boundaryWrap(boundary);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+#ifndef ANDROID
+    float border[4] = {constant, constant, constant, constant};
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+#endif
+}
+
+void initTexture2DR32F(GLuint id, uint64_t n, uint64_t m)
+{
+    initTexture2D(id, n, m, glFormat::R32F);
+}
+
+// upload rows [row, row+rows) of n texel wide data into storage made by
+//  initTexture2D
+void transferRowsToTexture2D(GLuint id, const void * data, uint64_t n, uint64_t row, uint64_t rows, glFormat format)
+{
+    glFormatInfo info = formatInfo(format);
+    glBindTexture(GL_TEXTURE_2D,id);
+    // rows of R16F or odd widths need not be 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        0,
+        row,
+        n,
+        rows,
+        info.format,
+        info.type,
+        static_cast<const uint8_t*>(data)+row*n*info.texelBytes()
+    );
+}
+
+// upload rows [row, row+rows) of the width texel wide tile at (x, y) in n
+//  texel wide data, rows counted in the data, to the tile's texture
+void transferTileRowsToTexture2D
+(
+    GLuint id,
+    const void * data,
+    uint64_t n,
+    uint64_t x,
+    uint64_t y,
+    uint64_t width,
+    uint64_t row,
+    uint64_t rows,
+    glFormat format
+)
+{
+    glFormatInfo info = formatInfo(format);
+    glBindTexture(GL_TEXTURE_2D,id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, n);
+
+    // data may be an offset into a bound unpack buffer
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        0,
+        row-y,
+        width,
+        rows,
+        info.format,
+        info.type,
+        reinterpret_cast<const uint8_t*>(data)+(row*n+x)*info.texelBytes()
+    );
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void transferToTexture2D(GLuint id, const void * data, uint64_t n, uint64_t m, glFormat format)
+{
+    transferRowsToTexture2D(id, data, n, 0, m, format);
+}
+
+void transferToTexture2DR32F(GLuint id, const float * data, uint64_t n, uint64_t m)
+{
+    transferToTexture2D(id, data, n, m, glFormat::R32F);
+}
+
+void transferToTexture2DR32F(GLuint id, const std::vector<float> & data, uint64_t n, uint64_t m)
+{
+    transferToTexture2DR32F(id, data.data(), n, m);
+}
+
+void initPixelBuffer(GLuint pbo, uint64_t bytes)
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData
+    (
+        GL_PIXEL_UNPACK_BUFFER,
+        bytes,
+        NULL,
+        GL_STREAM_DRAW
+    );
+    glAllocations()++;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// upload the spans of rows {row, rows} from the unpack buffer currently
+//  bound, where they sit at the same offsets as in the host data
+void transferRowsFromPixelBuffer
+(
+    GLuint id,
+    uint64_t n,
+    const std::vector<std::pair<uint64_t, uint64_t>> & spans,
+    glFormat format
+)
+{
+    glFormatInfo info = formatInfo(format);
+    glBindTexture(GL_TEXTURE_2D,id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (const auto & span : spans)
+    {
+        // with an unpack buffer bound the data pointer is an offset into it
+        glTexSubImage2D(
+            GL_TEXTURE_2D,
+            0,
+            0,
+            span.first,
+            n,
+            span.second,
+            info.format,
+            info.type,
+            reinterpret_cast<void*>(span.first*n*info.texelBytes())
+        );
+    }
+}
+
+// copy the spans of rows {row, rows} of n x m data to the same offsets
+//  in a pixel unpack buffer, which is left bound
+void stageRowsInPixelBuffer
+(
+    GLuint pbo,
+    const void * data,
+    uint64_t n,
+    uint64_t m,
+    const std::vector<std::pair<uint64_t, uint64_t>> & spans,
+    glFormat format
+)
+{
+    const uint64_t rowBytes = n*formatInfo(format).texelBytes();
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+
+    // invalidation lets the driver hand back fresh memory if the gpu
+    //  is still reading the previous contents of this buffer
+    uint8_t * staging = static_cast<uint8_t*>
+    (
+        glMapBufferRange
+        (
+            GL_PIXEL_UNPACK_BUFFER,
+            0,
+            rowBytes*m,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+        )
+    );
+
+    if (staging == nullptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        throw GLRuntimeException("stageRowsInPixelBuffer: could not map pixel buffer");
+    }
+
+    for (const auto & span : spans)
+    {
+        std::memcpy
+        (
+            staging+span.first*rowBytes,
+            static_cast<const uint8_t*>(data)+span.first*rowBytes,
+            span.second*rowBytes
+        );
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+// stage the spans of rows {row, rows} in a pixel unpack buffer and copy
+//  them from it to the texture, returns once the data is staged, the gpu
+//  copy happens asynchronously
+void transferRowsToTexture2D
+(
+    GLuint id,
+    GLuint pbo,
+    const void * data,
+    uint64_t n,
+    uint64_t m,
+    const std::vector<std::pair<uint64_t, uint64_t>> & spans,
+    glFormat format
+)
+{
+    stageRowsInPixelBuffer(pbo, data, n, m, spans, format);
+
+    transferRowsFromPixelBuffer(id, n, spans, format);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+struct AbstractUniform
+{
+    AbstractUniform(std::string n)
+    : name(n), location(-1)
+    {}
+
+    virtual ~AbstractUniform() = default;
+
+    std::string name;
+    // in the linked program, -1 until then
+    int location;
+};
+
+template <class T>
+struct Uniform : public AbstractUniform
+{
+    Uniform(std::string n, T v)
+    : AbstractUniform(n), value(v)
+    {}
+
+    T value;
+};
+
+template <class T>
+const Uniform NULL_UNIFORM("", static_cast<T>(NAN));
+
+struct Sampler2D {
+
+    Sampler2D(int t)
+    : texture(t)
+    {}
+
+    Sampler2D(unsigned t)
+    : texture(t)
+    {}
+
+    Sampler2D(float t)
+    : texture(int(t))
+    {}
+
+    int texture;
+};
+
+/*
+    Names declared by uniform statements in GLSL source, found in one pass
+     without regexes. "uniform highp float a, b[4];" gives a and b,
+     members of uniform blocks are not included.
+*/
+std::unordered_set<std::string> glslUniformNames(const std::string & source)
+{
+    std::unordered_set<std::string> names;
+    auto isWord = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+    const std::string keyword = "uniform";
+    for
+    (
+        size_t at = source.find(keyword);
+        at != std::string::npos;
+        at = source.find(keyword, at+keyword.size())
+    )
+    {
+        size_t after = at+keyword.size();
+        if ((at > 0 && isWord(source[at-1])) || (after < source.size() && isWord(source[after])))
+        {
+            continue;
+        }
+        size_t end = source.find_first_of(";{", after);
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        if (source[end] == '{')
+        {
+            continue;
+        }
+        // each declarator's name is its last word before any [ or =
+        std::string statement = source.substr(after, end-after);
+        int depth = 0;
+        size_t start = 0;
+        for (size_t i = 0; i <= statement.size(); i++)
+        {
+            char c = i < statement.size() ? statement[i] : ',';
+            if (c == '[' || c == '('){ depth++; }
+            else if (c == ']' || c == ')'){ depth--; }
+            else if (c == ',' && depth == 0)
+            {
+                std::string declarator = statement.substr(start, i-start);
+                declarator = declarator.substr(0, declarator.find_first_of("[="));
+                size_t last = declarator.find_last_not_of(" \t\r\n");
+                if (last != std::string::npos && isWord(declarator[last]))
+                {
+                    size_t first = last;
+                    while (first > 0 && isWord(declarator[first-1])){ first--; }
+                    names.insert(declarator.substr(first, last-first+1));
+                }
+                start = i+1;
+            }
+        }
+    }
+    return names;
+}
+
+// an active uniform of a linked program, arrays are named without "[0]"
+struct glUniformInfo
+{
+    std::string name;
+    GLenum type;
+    GLint size;
+    GLint location;
+};
+
+struct Shader
+{
+    Shader(const char * v, const char * f)
+    : vertex(v), fragment(f), declaredKnown(false), uniformsKnown(false)
+    {}
+
+    Shader()
+    : vertex(""),fragment(""), declaredKnown(false), uniformsKnown(false)
+    {}
+
+    Shader(std::string path, std::string name)
+    : declaredKnown(false), uniformsKnown(false)
+    {
+        std::ifstream fileVs(path+name+".vs");
+        std::ifstream fileFs(path+name+".fs");
+        if (fileVs.is_open() && fileFs.is_open())
+        {
+            vertex = parseShaderSource(fileVs);
+            fragment = parseShaderSource(fileFs);
+        }
+        else
+        {
+            throw std::runtime_error(" attempting to locate source files .vs and .fs at "+path+name);
+        }
+    }
+
+    virtual ~Shader() = default;
+
+    // the destructor would otherwise turn moves into copies
+    Shader(const Shader &) = default;
+    Shader & operator=(const Shader &) = default;
+    Shader(Shader &&) = default;
+    Shader & operator=(Shader &&) = default;
+
+    bool operator==(const Shader & s)
+    {
+        return this->vertex == s.vertex && this->fragment == s.fragment;
+    }
+
+    /*
+        Uniforms are known once the program links. Before then values are
+         held under the type given and kept if the linked program agrees.
+         Declared uniforms that are not active uniforms of a supported
+         type (optimised out, or e.g. uint) are ignored after linking,
+         names that are not declared throw.
+    */
+    template <class T>
+    void setUniform(std::string name, T value)
+    {
+        if (uniforms.find(name) == uniforms.end())
+        {
+            if (declaredUniforms().count(name) == 0)
+            {
+                throw std::runtime_error("could not find uniform: " + name);
+            }
+            if (uniformsKnown)
+            {
+                return;
+            }
+            uniforms[name] = std::make_shared<Uniform<T>>(name, value);
+        }
+
+        AbstractUniform * uniform = uniforms[name].get();
+
+        if (dynamic_cast<Uniform<T>*>(uniform) == nullptr)
+        {
+            return;
+        }
+
+        Uniform<T> * u = dynamic_cast<Uniform<T>*>(uniform);
+        if (u != nullptr){ setValue(u, value); return; }
+
+        return;
+    }
+
+    const std::string & getVertex() const { return vertex; }
+    const std::string & getFragment() const { return fragment; }
+
+    template <class T>
+    Uniform<T> getUniform(std::string name)
+    {
+        if (uniforms.find(name) == uniforms.end())
+        {
+            return NULL_UNIFORM<T>;
+        }
+
+        AbstractUniform * uniform = uniforms[name].get();
+
+        if (dynamic_cast<Uniform<T>*>(uniform) == nullptr)
+        {
+            return NULL_UNIFORM<T>;
+        }
+
+        Uniform<T> * u = dynamic_cast<Uniform<T>*>(uniform);
+        if (u != nullptr){ return *u; }
+
+        return NULL_UNIFORM<T>;
+    }
+
+    std::vector<std::string> getUniformNames()
+    {
+        std::vector<std::string> v;
+        for (auto it = uniforms.cbegin(); it != uniforms.cend(); it++)
+        {
+            v.push_back(it->first);
+        }
+        return v;
+    }
+
+    virtual void use() = 0;
+
+protected:
+
+    std::string vertex;
+    std::string fragment;
+
+    std::unordered_map<std::string, std::shared_ptr<AbstractUniform>> uniforms;
+    std::unordered_set<std::string> declared;
+    bool declaredKnown;
+    // whether uniforms holds the linked program's, rather than those set so far
+    bool uniformsKnown;
+
+    // every name declared as a uniform in either source, scanned once
+    const std::unordered_set<std::string> & declaredUniforms()
+    {
+        if (!declaredKnown)
+        {
+            declared = glslUniformNames(vertex);
+            for (const std::string & name : glslUniformNames(fragment))
+            {
+                declared.insert(name);
+            }
+            declaredKnown = true;
+        }
+        return declared;
+    }
+
+    std::string parseShaderSource(std::ifstream & file)
+    {
+        std::string src = "";
+        std::string line;
+        while (std::getline(file,line))
+        {
+            src += line + "\n";
+        }
+        return src;
+    }
+
+    virtual void compile() = 0;
+
+    // cannot have spec in class scope https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85282
+    //  also cannot use partial spec workaround because non-class, non-variable partial
+    //  specialization is not allowed
+    //  https://stackoverflow.com/questions/8061456/c-function-template-partial-specialization
+    // so the template dispatches to these guys
+
+    virtual void setValue(Uniform<int> * u, int value)
+    {
+        u->value = value;
+
+    }
+
+    virtual void setValue(Uniform<Sampler2D> * u, Sampler2D value)
+    {
+        u->value = value;
+    }
+
+    virtual void setValue(Uniform<float> * u, float value)
+    {
+        u->value = value;
+    }
+
+    virtual void setValue(Uniform<glm::vec2> * u, glm::vec2 value)
+    {
+        u->value = value;
+    }
+
+    virtual void setValue(Uniform<glm::vec4> * u, glm::vec4 value)
+    {
+        u->value = value;
+    }
+
+    virtual void setValue(Uniform<glm::mat4> * u, glm::mat4 value)
+    {
+        u->value = value;
+    }
+};
+
+/*
+    Linked programs are shared by every glShader with the same vertex and
+     fragment source, so identical kernels compile and link once per
+     process. Entries are keyed by the sources (hashed by the map) and
+     counted by the glShaders holding them. Uniform values live in the
+     program, so a glShader re-applies its own when another glShader set
+     the program's uniforms last (the entry's owner). A program still
+     compiling is shared with its job, so it is finished once.
+
+    Program names belong to a context's share group, disable the cache
+     before compiling under contexts that do not share objects.
+*/
+struct glProgramEntry
+{
+    GLuint program;
+    uint64_t references;
+    const void * owner;
+    glShaderJob job;
+};
+
+// never destroyed, glShaders with static storage may outlive it otherwise
+std::unordered_map<std::string, glProgramEntry> & glProgramCache()
+{
+    static auto * cache = new std::unordered_map<std::string, glProgramEntry>();
+    return *cache;
+}
+
+bool & glProgramCacheEnabled()
+{
+    static bool enabled = true;
+    return enabled;
+}
+
+struct glShader : public Shader
+{
+
+    glShader(const char * v, const char * f)
+    : Shader(v, f), program(0), compiled(false), linked(false), used(false), entry(nullptr)
+    {}
+
+    glShader()
+    : Shader(), program(0), compiled(false), linked(false), used(false), entry(nullptr)
+    {}
+
+    glShader(std::string path, std::string name)
+    : Shader(path, name), program(0), compiled(false), linked(false), used(false), entry(nullptr)
+    {}
+
+    glShader(const glShader &) = delete;
+    glShader & operator=(const glShader &) = delete;
+
+    glShader(glShader && s)
+    : Shader(std::move(s)), program(0), compiled(false), linked(false), used(false), entry(nullptr)
+    {
+        take(s);
+    }
+
+    glShader & operator=(glShader && s)
+    {
+        if (this != &s)
+        {
+            release();
+            Shader::operator=(std::move(s));
+            take(s);
+        }
+        return *this;
+    }
+
+    ~glShader(){release();}
+
+    void create()
+    {
+        if (!isProgram())
+        {
+            program = glCreateProgram();
+            compiled = false;
+        }
+    }
+
+    void release()
+    {
+        if (entry != nullptr)
+        {
+            if (entry->owner == this)
+            {
+                entry->owner = nullptr;
+            }
+            if (--entry->references == 0)
+            {
+                releaseShaderJob(entry->job);
+                glDeleteProgram(entry->program);
+                glProgramCache().erase(key());
+            }
+        }
+        else if (isProgram())
+        {
+            releaseShaderJob(job);
+            glDeleteProgram(program);
+        }
+        program = 0;
+        entry = nullptr;
+        compiled = false;
+        linked = false;
+    }
+
+    void compile()
+    {
+        submit();
+        wait();
+    }
+
+    /*
+        Start compiling and linking without waiting for the driver, so
+         programs submitted together compile in parallel where the
+         driver supports KHR_parallel_shader_compile. Errors are thrown
+         by wait(), which use() calls. Uniforms set before then are
+         uploaded when it links.
+    */
+    void submit()
+    {
+        if (entry != nullptr)
+        {
+            release();
+        }
+        releaseShaderJob(job);
+        job = glShaderJob();
+        linked = false;
+
+        auto cached = glProgramCache().find(key());
+        if (glProgramCacheEnabled() && cached != glProgramCache().end())
+        {
+            if (isProgram())
+            {
+                glDeleteProgram(program);
+            }
+            entry = &cached->second;
+            entry->references++;
+            program = entry->program;
+        }
+        else
+        {
+            create();
+            job = submitShaderCached(program,vertex.c_str(),fragment.c_str());
+            if (glProgramCacheEnabled())
+            {
+                entry = &(glProgramCache()[key()] = {program, 1, nullptr, job});
+                job = glShaderJob();
+            }
+        }
+        compiled = true;
+    }
+
+    // block until submitted, throw if it failed, then upload the uniforms
+    void wait()
+    {
+        if (!compiled){submit();}
+        if (linked){return;}
+
+        glShaderJob & pending = entry != nullptr ? entry->job : job;
+        finishShaderCached(pending, vertex.c_str(), fragment.c_str());
+        linked = true;
+        introspectUniforms();
+
+        glUseProgram(program);
+        if (entry != nullptr)
+        {
+            entry->owner = this;
+        }
+        applyUniforms();
+    }
+
+    // false while the driver reports the submitted program is still
+    //  compiling, so polling always ends (see shaderReady). Before submit
+    //  there is nothing to poll, wait() compiles
+    bool isReady()
+    {
+        if (!compiled || linked){return true;}
+        return shaderReady(entry != nullptr ? entry->job : job);
+    }
+
+    void use()
+    {
+        if (!linked){wait(); return;}
+        glUseProgram(program);
+        if (entry != nullptr && entry->owner != this)
+        {
+            entry->owner = this;
+            applyUniforms();
+        }
+    }
+
+    bool isCompiled(){return compiled;}
+    bool isLinked(){return linked;}
+    bool isProgram(){return glIsProgram(program);}
+
+    // every active uniform, including types setUniform does not handle
+    //  (e.g. uint, ivec2, mat3), empty until linked
+    const std::vector<glUniformInfo> & getUniformTable() const { return uniformTable; }
+
+    // -1 if name is not an active uniform (or not linked yet)
+    GLint location(const std::string & name) const
+    {
+        auto u = uniforms.find(name);
+        if (u != uniforms.end())
+        {
+            return u->second->location;
+        }
+        for (const glUniformInfo & info : uniformTable)
+        {
+            if (info.name == name)
+            {
+                return info.location;
+            }
+        }
+        return -1;
+    }
+
+private:
+
+    GLuint program;
+    bool compiled;
+    bool linked;
+    bool used;
+    glProgramEntry * entry;
+    // the pending compile when not shared through the cache
+    glShaderJob job;
+    std::vector<glUniformInfo> uniformTable;
+
+    std::string key() const { return vertex+'\0'+fragment; }
+
+    // move s's program here, the entry's owner may be s's address
+    void take(glShader & s)
+    {
+        program = s.program;
+        compiled = s.compiled;
+        linked = s.linked;
+        entry = s.entry;
+        job = s.job;
+        uniformTable = std::move(s.uniformTable);
+        if (entry != nullptr)
+        {
+            entry->owner = nullptr;
+        }
+        s.program = 0;
+        s.compiled = false;
+        s.linked = false;
+        s.entry = nullptr;
+        s.job = glShaderJob();
+        s.uniformTable.clear();
+        // moved from, but no longer sharing values with this either way
+        s.uniforms.clear();
+    }
+
+    /*
+        Fill the uniform table from the linked program and keep a value
+         for each active uniform of a supported type. Values set before
+         linking survive when their type matches, the rest start at 0.
+    */
+    void introspectUniforms()
+    {
+        uniformTable.clear();
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<GLchar> buffer(std::max(maxLength, 1));
+
+        std::unordered_map<std::string, std::shared_ptr<AbstractUniform>> active;
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, GLuint(i), GLsizei(buffer.size()), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            // arrays report their first element
+            if (name.size() > 3 && name.compare(name.size()-3, 3, "[0]") == 0)
+            {
+                name.erase(name.size()-3);
+            }
+            // -1 for members of uniform blocks
+            GLint at = glGetUniformLocation(program, name.c_str());
+            uniformTable.push_back({name, type, size, at});
+            if (at < 0)
+            {
+                continue;
+            }
+
+            auto previous = uniforms.find(name);
+            std::shared_ptr<AbstractUniform> u = uniformOf
+            (
+                type,
+                name,
+                previous == uniforms.end() ? nullptr : previous->second
+            );
+            if (u != nullptr)
+            {
+                u->location = at;
+                active[name] = u;
+            }
+        }
+        uniforms = active;
+        uniformsKnown = true;
+    }
+
+    template <class T>
+    static std::shared_ptr<AbstractUniform> keepOrCreate(const std::string & name, std::shared_ptr<AbstractUniform> previous)
+    {
+        if (std::dynamic_pointer_cast<Uniform<T>>(previous) != nullptr)
+        {
+            return previous;
+        }
+        return std::make_shared<Uniform<T>>(name, T(0));
+    }
+
+    // nullptr for types without a Uniform<T>
+    static std::shared_ptr<AbstractUniform> uniformOf(GLenum type, const std::string & name, std::shared_ptr<AbstractUniform> previous)
+    {
+        switch (type)
+        {
+            case GL_INT:
+            case GL_BOOL:
+                return keepOrCreate<int>(name, previous);
+            case GL_FLOAT:
+                return keepOrCreate<float>(name, previous);
+            case GL_FLOAT_VEC2:
+                return keepOrCreate<glm::vec2>(name, previous);
+            case GL_FLOAT_VEC4:
+                return keepOrCreate<glm::vec4>(name, previous);
+            case GL_FLOAT_MAT4:
+                return keepOrCreate<glm::mat4>(name, previous);
+            case GL_SAMPLER_2D:
+            case GL_INT_SAMPLER_2D:
+            case GL_UNSIGNED_INT_SAMPLER_2D:
+                return keepOrCreate<Sampler2D>(name, previous);
+            default:
+                return nullptr;
+        }
+    }
+
+    // every uniform's value, to a program last set by another glShader
+    void applyUniforms()
+    {
+        for (auto uniform = uniforms.cbegin(); uniform != uniforms.cend(); uniform++)
+        {
+            AbstractUniform * u = (*uniform).second.get();
+
+            Uniform<int> * ui = dynamic_cast<Uniform<int>*>(u);
+            if (ui != nullptr){ upload(ui); continue; }
+
+            Uniform<Sampler2D> * us = dynamic_cast<Uniform<Sampler2D>*>(u);
+            if (us != nullptr){ upload(us); continue; }
+
+            Uniform<float> * uf = dynamic_cast<Uniform<float>*>(u);
+            if (uf != nullptr){ upload(uf); continue; }
+
+            Uniform<glm::vec2> * uv = dynamic_cast<Uniform<glm::vec2>*>(u);
+            if (uv != nullptr){ upload(uv); continue; }
+
+            Uniform<glm::vec4> * uv4 = dynamic_cast<Uniform<glm::vec4>*>(u);
+            if (uv4 != nullptr){ upload(uv4); continue; }
+
+            Uniform<glm::mat4> * um = dynamic_cast<Uniform<glm::mat4>*>(u);
+            if (um != nullptr){ upload(um); continue; }
+        }
+    }
+
+    void upload(Uniform<int> * u)
+    {
+        glUniform1i(u->location, u->value);
+    }
+
+    void upload(Uniform<Sampler2D> * u)
+    {
+        glUniform1i(u->location, u->value.texture);
+    }
+
+    void upload(Uniform<float> * u)
+    {
+        glUniform1f(u->location, u->value);
+    }
+
+    void upload(Uniform<glm::vec2> * u)
+    {
+        glUniform2f(u->location, u->value.x, u->value.y);
+    }
+
+    void upload(Uniform<glm::vec4> * u)
+    {
+        glUniform4f(u->location, u->value.x, u->value.y, u->value.z, u->value.w);
+    }
+
+    void upload(Uniform<glm::mat4> * u)
+    {
+        glUniformMatrix4fv(u->location, 1, false, glm::value_ptr(u->value));
+    }
+
+    // cannot have spec in class scope https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85282
+    //  also cannot use partial spec workaround because non-class, non-variable partial
+    //  specialization is not allowed
+    //  https://stackoverflow.com/questions/8061456/c-function-template-partial-specialization
+    // so the template dispatches to these guys
+
+    void setValue(Uniform<int> * u, int value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+
+    }
+
+    void setValue(Uniform<Sampler2D> * u, Sampler2D value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+
+    }
+
+    void setValue(Uniform<float> * u, float value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+
+    }
+
+    void setValue(Uniform<glm::vec2> * u, glm::vec2 value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+
+    }
+
+    void setValue(Uniform<glm::vec4> * u, glm::vec4 value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+
+    }
+
+    void setValue(Uniform<glm::mat4> * u, glm::mat4 value)
+    {
+        u->value = value;
+        if (isLinked())
+        {
+            use();
+            upload(u);
+        }
+    }
+
+};
+
+// give buffer immutable storage and map it for its whole lifetime,
+//  returns nullptr when persistent mapping is not supported or fails
+void * initPersistentBuffer(GLenum target, GLuint buffer, uint64_t bytes, GLbitfield access)
+{
+#ifdef ANDROID
+    return nullptr;
+#else
+    if (!glHasBufferStorage())
+    {
+        return nullptr;
+    }
+    GLbitfield flags = access | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBindBuffer(target, buffer);
+    glBufferStorage(target, bytes, NULL, flags);
+    glAllocations()++;
+    void * mapped = glMapBufferRange(target, 0, bytes, flags);
+    glBindBuffer(target, 0);
+    return mapped;
+#endif
+}
+
+// block until the gpu has passed fence
+void waitFence(GLsync fence)
+{
+    GLenum status = GL_TIMEOUT_EXPIRED;
+    while (status == GL_TIMEOUT_EXPIRED)
+    {
+        // flush so the fence is guaranteed to reach the gpu
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    if (status == GL_WAIT_FAILED)
+    {
+        throw GLRuntimeException("waitFence: glClientWaitSync failed");
+    }
+}
+
+// non owning view of count contiguous elements, converts to a vector
+template <class T>
+struct ArrayView
+{
+    ArrayView(T * data, uint64_t count)
+    : ptr(data), count(count)
+    {}
+
+    T & operator[](uint64_t i) const { return ptr[i]; }
+
+    T * data() const { return ptr; }
+    uint64_t size() const { return count; }
+
+    T * begin() const { return ptr; }
+    T * end() const { return ptr+count; }
+
+    operator std::vector<typename std::remove_const<T>::type>() const
+    {
+        return std::vector<typename std::remove_const<T>::type>(begin(), end());
+    }
+
+private:
+
+    T * ptr;
+    uint64_t count;
+};
+
+/*
+    The n x m texture holding length elements row by row, n is the
+     square root rounded up to a multiple of 4, so rows suit RGBA reads,
+     and the padding sits at the end of the last row.
+*/
+std::pair<uint64_t, uint64_t> linearLayout(uint64_t length)
+{
+    uint64_t n = std::ceil(std::sqrt(double(std::max(length, uint64_t(1)))));
+    n = (n+3)/4*4;
+    return {n, (length+n-1)/n};
+}
+
+// insert code after source's #version directive and any #extension or
+//  #pragma lines following it, #extension must precede other tokens
+std::string insertAfterVersion(std::string source, std::string code)
+{
+    if (code.empty())
+    {
+        return source;
+    }
+    std::size_t version = source.find("#version");
+    if (version == std::string::npos)
+    {
+        return code+source;
+    }
+    std::size_t line = source.find("\n", version);
+    if (line == std::string::npos)
+    {
+        return source+"\n"+code;
+    }
+    std::size_t after = line+1;
+    // skip blank and // comment lines, stop at the first other line
+    for (std::size_t start = after; start < source.size();)
+    {
+        std::size_t end = source.find("\n", start);
+        std::size_t lineEnd = end == std::string::npos ? source.size() : end;
+        std::size_t next = end == std::string::npos ? source.size() : end+1;
+        std::size_t text = source.find_first_not_of(" \t\r", start);
+        if (text == std::string::npos || text >= lineEnd)
+        {
+            start = next;
+            continue;
+        }
+        if (source.compare(text, 10, "#extension") == 0 || source.compare(text, 7, "#pragma") == 0)
+        {
+            if (end == std::string::npos)
+            {
+                return source+"\n"+code;
+            }
+            after = next;
+        }
+        else if (source.compare(text, 2, "//") != 0)
+        {
+            break;
+        }
+        start = next;
+    }
+    return source.insert(after, code);
+}
+
+/*
+    Pixel pack buffers of one size, handed to readback tickets and given
+     back when a ticket is read or destroyed, so a steady state readback
+     loop allocates nothing. Up to RING buffers are kept, more are only
+     made while that many tickets are outstanding. Shared by the owner
+     and its tickets, either may be destroyed first.
+*/
+class glPackBufferPool
+{
+
+public:
+
+    static constexpr uint8_t RING = 3;
+
+    glPackBufferPool(uint64_t bytes)
+    : bytes(bytes)
+    {}
+
+    glPackBufferPool(const glPackBufferPool &) = delete;
+    glPackBufferPool & operator=(const glPackBufferPool &) = delete;
+
+    ~glPackBufferPool()
+    {
+        if (!buffers.empty())
+        {
+            glDeleteBuffers(buffers.size(), buffers.data());
+        }
+    }
+
+    GLuint acquire()
+    {
+        if (!buffers.empty())
+        {
+            GLuint pbo = buffers.back();
+            buffers.pop_back();
+            return pbo;
+        }
+        GLuint pbo;
+        glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+        glAllocations()++;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return pbo;
+    }
+
+    void give(GLuint pbo)
+    {
+        if (buffers.size() < RING)
+        {
+            buffers.push_back(pbo);
+        }
+        else
+        {
+            glDeleteBuffers(1, &pbo);
+        }
+    }
+
+    uint64_t size() const { return bytes; }
+
+private:
+
+    uint64_t bytes;
+    std::vector<GLuint> buffers;
+};
+
+/*
+    A pending read of a texture into a pixel pack buffer.
+
+    glReadPixels into a pack buffer returns immediately, the fence
+     tells us when the gpu has finished writing it. Poll with ready(),
+     block with wait() and collect the data with get().
+*/
+class glReadback
+{
+
+public:
+
+    /*
+        rowElements, when non zero, keeps only the first rowElements
+         elements of each n texel row (dropping padding), and length,
+         when non zero, only the first length elements in all
+    */
+    glReadback
+    (
+        GLuint pbo,
+        GLsync fence,
+        uint64_t n,
+        uint64_t m,
+        glFormat format = glFormat::R32F,
+        uint64_t rowElements = 0,
+        uint64_t length = 0,
+        std::shared_ptr<glPackBufferPool> pool = nullptr
+    )
+    : pbo(pbo), fence(fence), n(n), m(m), format(format),
+      rowElements(rowElements == 0 ? n*formatInfo(format).channels : rowElements),
+      length(length),
+      done(false),
+      pool(pool)
+    {}
+
+    glReadback(const glReadback &) = delete;
+    glReadback & operator=(const glReadback &) = delete;
+
+    glReadback(glReadback && r) noexcept
+    : pbo(r.pbo), fence(r.fence), n(r.n), m(r.m), format(r.format),
+      rowElements(r.rowElements), length(r.length), done(r.done), data(std::move(r.data)),
+      pool(std::move(r.pool))
+    {
+        r.pbo = 0;
+        r.fence = nullptr;
+    }
+
+    glReadback & operator=(glReadback && r) noexcept
+    {
+        if (this != &r)
+        {
+            release();
+            pbo = r.pbo;
+            fence = r.fence;
+            n = r.n;
+            m = r.m;
+            format = r.format;
+            rowElements = r.rowElements;
+            length = r.length;
+            done = r.done;
+            data = std::move(r.data);
+            pool = std::move(r.pool);
+            r.pbo = 0;
+            r.fence = nullptr;
+        }
+        return *this;
+    }
+
+    ~glReadback(){ release(); }
+
+    bool ready()
+    {
+        if (done || fence == nullptr) { return true; }
+        // flush so the fence is guaranteed to reach the gpu
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_WAIT_FAILED)
+        {
+            throw GLRuntimeException("glReadback::ready: glClientWaitSync failed");
+        }
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    void wait()
+    {
+        if (done || fence == nullptr) { return; }
+        waitFence(fence);
+    }
+
+    // T must be the host element type of the read format
+    template <class T = float>
+    ArrayView<const T> get()
+    {
+        if (!isHostType<T>(format))
+        {
+            throw std::runtime_error("glReadback::get: element type does not match the format");
+        }
+
+        uint64_t elements = rowElements*m;
+        if (length != 0)
+        {
+            elements = std::min(elements, length);
+        }
+
+        if (!done)
+        {
+            wait();
+
+            data = makeHostVector(format, n*m*formatInfo(format).channels);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+            void * mapped = glMapBufferRange
+            (
+                GL_PIXEL_PACK_BUFFER,
+                0,
+                n*m*formatInfo(format).texelBytes(),
+                GL_MAP_READ_BIT
+            );
+            if (mapped == nullptr)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                throw GLRuntimeException("glReadback::get: could not map pixel buffer");
+            }
+            // copy row by row when dropping padding
+            uint64_t bytes = rowElements*formatInfo(format).channelBytes;
+            uint64_t stride = n*formatInfo(format).texelBytes();
+            uint64_t rows = m;
+            if (bytes == stride)
+            {
+                bytes *= m;
+                rows = 1;
+            }
+            for (uint64_t row = 0; row < rows; row++)
+            {
+                std::memcpy
+                (
+                    static_cast<uint8_t*>(hostData(data))+row*bytes,
+                    static_cast<const uint8_t*>(mapped)+row*stride,
+                    bytes
+                );
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            release();
+            done = true;
+        }
+
+        return ArrayView<const T>(static_cast<const T*>(hostData(data)), elements);
+    }
+
+private:
+
+    GLuint pbo;
+    GLsync fence;
+    uint64_t n, m;
+    glFormat format;
+    uint64_t rowElements;
+    uint64_t length;
+    bool done;
+    HostVector data;
+    // where pbo goes back to, deleted without one
+    std::shared_ptr<glPackBufferPool> pool;
+
+    void release()
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        if (pbo != 0)
+        {
+            if (pool != nullptr)
+            {
+                pool->give(pbo);
+            }
+            else
+            {
+                glDeleteBuffers(1, &pbo);
+            }
+            pbo = 0;
+        }
+    }
+};
+
+/*
+    Plumbing shared by the multi-pass primitives below (glReducer,
+     glScanner, glSorter, glGemm, glFFT, glStencil, glScatter): a frame buffer, an empty vertex array for a single
+     triangle covering the viewport, and scratch textures kept by size
+     so repeated passes allocate nothing.
+*/
+class glPasses
+{
+
+public:
+
+    glPasses(const glPasses &) = delete;
+    glPasses & operator=(const glPasses &) = delete;
+
+protected:
+
+    glPasses()
+    {
+        glGenFramebuffers(1, &frameBuffer);
+        glGenVertexArrays(1, &vao);
+    }
+
+    ~glPasses()
+    {
+        for (auto & texture : scratch)
+        {
+            glDeleteTextures(1, &texture.second);
+        }
+        glDeleteFramebuffers(1, &frameBuffer);
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    const char * vertexShader =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "void main(){\n"
+        "   gl_Position = vec4(float((gl_VertexID & 1)*4-1), float((gl_VertexID >> 1)*4-1), 0.0, 1.0);\n"
+        "}";
+
+    // the slot'th scratch texture of this size and format
+    GLuint texture(uint64_t n, uint64_t m, glFormat format, int slot = 0)
+    {
+        auto key = std::make_tuple(n, m, int(format), slot);
+        if (scratch.find(key) == scratch.end())
+        {
+            GLuint id;
+            glGenTextures(1, &id);
+            initTexture2D(id, n, m, format);
+            scratch[key] = id;
+        }
+        return scratch[key];
+    }
+
+    void begin()
+    {
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        glBindVertexArray(vao);
+        glDepthMask(false);
+        glDisable(GL_BLEND);
+    }
+
+    // draw the bound program into the n x m output
+    void draw(GLuint output, uint64_t n, uint64_t m)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+        glViewport(0, 0, n, m);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // draw into n x m outputs at once, output i is layout(location = i)
+    void draw(const std::vector<GLuint> & outputs, uint64_t n, uint64_t m)
+    {
+        std::vector<GLenum> buffers;
+        for (uint64_t i = 0; i < outputs.size(); i++)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+i, GL_TEXTURE_2D, outputs[i], 0);
+            buffers.push_back(GL_COLOR_ATTACHMENT0+i);
+        }
+        glDrawBuffers(buffers.size(), buffers.data());
+        glViewport(0, 0, n, m);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        // back to the single attachment the other draws expect
+        for (uint64_t i = 1; i < outputs.size(); i++)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0+i, GL_TEXTURE_2D, 0, 0);
+        }
+        GLenum first = GL_COLOR_ATTACHMENT0;
+        glDrawBuffers(1, &first);
+    }
+
+    void end()
+    {
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    GLuint frameBuffer, vao;
+
+private:
+
+    std::map<std::tuple<uint64_t, uint64_t, int, int>, GLuint> scratch;
+    GLint viewport[4];
+};
+
+enum class glReduction {Sum, Min, Max, Mean};
+
+/*
+    Reduces an R32F texture to one value on the gpu. Each pass draws a
+     texture a quarter the size in each dimension, every fragment
+     combining a 4x4 block, until one texel is left to read back.
+*/
+class glReducer : public glPasses
+{
+
+public:
+
+    /*
+        Reduce the n x m texture, only its first length texels (row by
+         row) when length is non zero, e.g. for a padded 1D layout.
+    */
+    float reduce(GLuint input, uint64_t n, uint64_t m, glReduction op, uint64_t length = 0)
+    {
+        uint64_t count = length == 0 ? n*m : std::min(length, n*m);
+
+        glShader & shader = program(op == glReduction::Mean ? glReduction::Sum : op);
+        shader.use();
+        begin();
+
+        glActiveTexture(GL_TEXTURE0);
+        shader.setUniform("glc_input", Sampler2D(0));
+        uint64_t limit = count;
+        do
+        {
+            n = (n+3)/4;
+            m = (m+3)/4;
+            GLuint output = texture(n, m, glFormat::R32F);
+            glBindTexture(GL_TEXTURE_2D, input);
+            shader.setUniform("glc_length", int(std::min(limit, uint64_t(INT32_MAX))));
+            draw(output, n, m);
+            input = output;
+            // later levels are fully valid
+            limit = n*m;
+        } while (n > 1 || m > 1);
+
+        float value;
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, 1, 1, GL_RED, GL_FLOAT, &value);
+
+        end();
+
+        return op == glReduction::Mean ? value/float(count) : value;
+    }
+
+private:
+
+    std::map<glReduction, std::unique_ptr<glShader>> shaders;
+
+    glShader & program(glReduction op)
+    {
+        if (shaders.find(op) == shaders.end())
+        {
+            std::string identity = "0.0";
+            std::string combine = "a+b";
+            if (op == glReduction::Min)
+            {
+                identity = "uintBitsToFloat(0x7F800000u)";
+                combine = "min(a, b)";
+            }
+            else if (op == glReduction::Max)
+            {
+                identity = "-uintBitsToFloat(0x7F800000u)";
+                combine = "max(a, b)";
+            }
+            std::string fragment =
+                "#version " GLSL_VERSION "\n"
+                "precision highp float;\n"
+                "precision highp int;\n"
+                "uniform highp sampler2D glc_input;\n"
+                "uniform int glc_length;\n"
+                "layout(location = 0) out float o_value;\n"
+                "float combine(float a, float b){ return "+combine+"; }\n"
+                "void main(){\n"
+                "   ivec2 size = textureSize(glc_input, 0);\n"
+                "   ivec2 base = ivec2(gl_FragCoord.xy)*4;\n"
+                "   float value = "+identity+";\n"
+                "   for (int j = 0; j < 4; j++){\n"
+                "       for (int i = 0; i < 4; i++){\n"
+                "           ivec2 p = base+ivec2(i, j);\n"
+                "           if (p.x < size.x && p.y < size.y && p.y*size.x+p.x < glc_length){\n"
+                "               value = combine(value, texelFetch(glc_input, p, 0).r);\n"
+                "           }\n"
+                "       }\n"
+                "   }\n"
+                "   o_value = value;\n"
+                "}";
+            shaders[op] = std::make_unique<glShader>(vertexShader, fragment.c_str());
+            shaders[op]->compile();
+        }
+        return *shaders[op];
+    }
+};
+
+/*
+    Prefix sums of an R32F texture on the gpu, Hillis-Steele style: pass
+     k adds the element 2^k before, ping-ponging between the texture and
+     a scratch texture, so log2(length) passes (plus one for exclusive
+     scans, and one copy back when the count is odd). The result is
+     left in the scanned texture.
+
+    Elements are ordered row by row, or each row is scanned on its own
+     with rows.
+*/
+class glScanner : public glPasses
+{
+
+public:
+
+    void scan(GLuint data, uint64_t n, uint64_t m, bool inclusive = true, bool rows = false)
+    {
+        uint64_t length = rows ? n : n*m;
+
+        // the offsets of each pass, 0 copies, exclusive scans shift first
+        std::vector<uint64_t> offsets;
+        if (!inclusive)
+        {
+            offsets.push_back(1);
+        }
+        for (uint64_t offset = 1; offset < length; offset *= 2)
+        {
+            offsets.push_back(offset);
+        }
+        if (offsets.size() % 2 == 1)
+        {
+            offsets.push_back(0);
+        }
+
+        if (shader == nullptr)
+        {
+            shader = std::make_unique<glShader>(vertexShader, fragment);
+            shader->compile();
+        }
+        shader->use();
+        begin();
+
+        glActiveTexture(GL_TEXTURE0);
+        shader->setUniform("glc_input", Sampler2D(0));
+        shader->setUniform("glc_rows", int(rows));
+        GLuint from = data;
+        GLuint to = texture(n, m, glFormat::R32F);
+        for (uint64_t pass = 0; pass < offsets.size(); pass++)
+        {
+            bool shift = !inclusive && pass == 0;
+            shader->setUniform("glc_offset", int(offsets[pass]));
+            shader->setUniform("glc_shift", int(shift));
+            glBindTexture(GL_TEXTURE_2D, from);
+            draw(to, n, m);
+            std::swap(from, to);
+        }
+
+        end();
+    }
+
+private:
+
+    std::unique_ptr<glShader> shader;
+
+    const char * fragment =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "uniform highp sampler2D glc_input;\n"
+        "uniform int glc_offset;\n"
+        "uniform int glc_rows;\n"
+        "uniform int glc_shift;\n"
+        "layout(location = 0) out float o_value;\n"
+        "void main(){\n"
+        "   int width = textureSize(glc_input, 0).x;\n"
+        "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+        "   int i = glc_rows == 1 ? p.x : p.y*width+p.x;\n"
+        "   float value = glc_shift == 1 ? 0.0 : texelFetch(glc_input, p, 0).r;\n"
+        "   if (glc_offset > 0 && i >= glc_offset){\n"
+        "       int j = i-glc_offset;\n"
+        "       ivec2 q = glc_rows == 1 ? ivec2(j, p.y) : ivec2(j % width, j / width);\n"
+        "       value += texelFetch(glc_input, q, 0).r;\n"
+        "   }\n"
+        "   o_value = value;\n"
+        "}";
+};
+
+/*
+    Sorts R32F or R32UI keys ascending on the gpu with a bitonic network.
+     Keys become (orderable uint bits, index) pairs in an RG32UI texture,
+     so ties keep their order and floats compare as uints (negative
+     floats have all bits flipped, positive ones the sign bit set). Each
+     pass compare-exchanges every element with its partner index, the
+     lower index keeping the smaller pair, in the variant where each
+     merge starts by comparing mirrored halves, so all comparators point
+     the same way. Elements beyond the texture, up to a power of two,
+     act as +infinity and need no storage.
+
+    The sorted keys and any payload textures are then gathered by the
+     resulting permutation, in place. Payloads must be n x m, like the
+     keys, and have the format given with them, sort() throws otherwise.
+     Texels past length (when non zero) are sorted to the end.
+*/
+class glSorter : public glPasses
+{
+
+public:
+
+    void sort
+    (
+        GLuint keys,
+        uint64_t n,
+        uint64_t m,
+        glFormat keyFormat,
+        std::vector<std::pair<GLuint, glFormat>> payloads = {},
+        uint64_t length = 0
+    )
+    {
+        if (keyFormat != glFormat::R32F && keyFormat != glFormat::R32UI)
+        {
+            throw std::runtime_error("glSorter: keys must be R32F or R32UI");
+        }
+        for (const auto & payload : payloads)
+        {
+            checkPayload(payload.first, n, m, payload.second);
+        }
+        uint64_t texels = n*m;
+        uint64_t count = length == 0 ? texels : std::min(length, texels);
+        uint64_t size = 1;
+        while (size < texels) { size *= 2; }
+
+        begin();
+        glActiveTexture(GL_TEXTURE0);
+
+        GLuint from = texture(n, m, glFormat::RG32UI, 0);
+        GLuint to = texture(n, m, glFormat::RG32UI, 1);
+
+        glShader & init = program(keyFormat == glFormat::R32F ? "init" : "initu");
+        init.use();
+        init.setUniform("glc_input", Sampler2D(0));
+        init.setUniform("glc_length", int(count));
+        glBindTexture(GL_TEXTURE_2D, keys);
+        draw(from, n, m);
+
+        glShader & merge = program("merge");
+        merge.use();
+        merge.setUniform("glc_input", Sampler2D(0));
+        merge.setUniform("glc_texels", int(texels));
+        for (uint64_t block = 2; block <= size; block *= 2)
+        {
+            for (uint64_t distance = block/2; distance > 0; distance /= 2)
+            {
+                bool flip = distance == block/2;
+                merge.setUniform("glc_partner", int(flip ? block-1 : distance));
+                glBindTexture(GL_TEXTURE_2D, from);
+                draw(to, n, m);
+                std::swap(from, to);
+            }
+        }
+        order = from;
+
+        payloads.insert(payloads.begin(), {keys, keyFormat});
+        for (const auto & payload : payloads)
+        {
+            gather(payload.first, n, m, payload.second);
+        }
+
+        end();
+    }
+
+    // the (key bits, original index) pairs of the last sort
+    GLuint permutation() const { return order; }
+
+private:
+
+    std::map<std::string, std::unique_ptr<glShader>> shaders;
+    GLuint order = 0;
+
+    // payloads are gathered as n x m textures of their format
+    void checkPayload(GLuint payload, uint64_t n, uint64_t m, glFormat format)
+    {
+        GLint width = 0, height = 0, internal = 0;
+        glBindTexture(GL_TEXTURE_2D, payload);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (uint64_t(width) != n || uint64_t(height) != m)
+        {
+            throw std::runtime_error("glSorter: payload is not the keys' size");
+        }
+        if (GLenum(internal) != formatInfo(format).internalFormat)
+        {
+            throw std::runtime_error("glSorter: payload does not have its given format");
+        }
+    }
+
+    // data[i] = data[index of i], through a scratch copy
+    void gather(GLuint data, uint64_t n, uint64_t m, glFormat format)
+    {
+        glFormatInfo info = formatInfo(format);
+        std::string prefix = std::string(info.sampler).substr(0, std::string(info.sampler).find("sampler"));
+        glShader & shader = program("gather"+prefix);
+        shader.use();
+        shader.setUniform("glc_input", Sampler2D(0));
+        shader.setUniform("glc_order", Sampler2D(1));
+        GLuint copy = texture(n, m, format, 2);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, order);
+        glActiveTexture(GL_TEXTURE0);
+
+        shader.setUniform("glc_permute", 1);
+        glBindTexture(GL_TEXTURE_2D, data);
+        draw(copy, n, m);
+
+        shader.setUniform("glc_permute", 0);
+        glBindTexture(GL_TEXTURE_2D, copy);
+        draw(data, n, m);
+    }
+
+    glShader & program(std::string name)
+    {
+        if (shaders.find(name) != shaders.end())
+        {
+            return *shaders[name];
+        }
+
+        std::string header =
+            "#version " GLSL_VERSION "\n"
+            "precision highp float;\n"
+            "precision highp int;\n";
+        std::string fragment;
+        if (name == "init" || name == "initu")
+        {
+            std::string bits = name == "init" ?
+                "uint u = floatBitsToUint(texelFetch(glc_input, p, 0).r);\n"
+                "   u = (u & 0x80000000u) != 0u ? ~u : u | 0x80000000u;\n" :
+                "uint u = texelFetch(glc_input, p, 0).r;\n";
+            fragment = header +
+                "uniform highp "+(name == "init" ? "sampler2D" : "usampler2D")+" glc_input;\n"
+                "uniform int glc_length;\n"
+                "layout(location = 0) out uvec2 o_value;\n"
+                "void main(){\n"
+                "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+                "   int i = p.y*textureSize(glc_input, 0).x+p.x;\n"
+                "   "+bits+
+                "   o_value = uvec2(i < glc_length ? u : 0xFFFFFFFFu, uint(i));\n"
+                "}";
+        }
+        else if (name == "merge")
+        {
+            fragment = header +
+                "uniform highp usampler2D glc_input;\n"
+                "uniform int glc_partner;\n"
+                "uniform int glc_texels;\n"
+                "layout(location = 0) out uvec2 o_value;\n"
+                "bool less(uvec2 a, uvec2 b){ return a.x < b.x || (a.x == b.x && a.y < b.y); }\n"
+                "void main(){\n"
+                "   int width = textureSize(glc_input, 0).x;\n"
+                "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+                "   int i = p.y*width+p.x;\n"
+                "   // on the first pass of a merge glc_partner is block-1, mirroring\n"
+                "   int j = i ^ glc_partner;\n"
+                "   uvec2 a = texelFetch(glc_input, p, 0).rg;\n"
+                "   uvec2 b = j < glc_texels ?\n"
+                "       texelFetch(glc_input, ivec2(j % width, j / width), 0).rg : uvec2(0xFFFFFFFFu, uint(j));\n"
+                "   o_value = (i < j) == less(a, b) ? a : b;\n"
+                "}";
+        }
+        else
+        {
+            // gather, gatheri or gatheru
+            std::string prefix = name.substr(6);
+            fragment = header +
+                "uniform highp "+prefix+"sampler2D glc_input;\n"
+                "uniform highp usampler2D glc_order;\n"
+                "uniform int glc_permute;\n"
+                "layout(location = 0) out "+prefix+"vec4 o_value;\n"
+                "void main(){\n"
+                "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+                "   if (glc_permute == 1){\n"
+                "       int width = textureSize(glc_input, 0).x;\n"
+                "       int i = int(texelFetch(glc_order, p, 0).g);\n"
+                "       p = ivec2(i % width, i / width);\n"
+                "   }\n"
+                "   o_value = texelFetch(glc_input, p, 0);\n"
+                "}";
+        }
+        shaders[name] = std::make_unique<glShader>(vertexShader, fragment.c_str());
+        shaders[name]->compile();
+        return *shaders[name];
+    }
+};
+
+/*
+    Dense C = alpha A B + beta C for row major float matrices, A m x k,
+     B k x n, C m x n. Matrices live in RGBA32F textures four columns to
+     a texel (a row major matrix with a multiple of 4 columns already is
+     that layout), rows padded with zeros to a multiple of 4.
+
+    Each fragment computes a rows x 4 block of C, one texel in each of
+     rows consecutive rows: per texel of K it fetches the four matching
+     rows of B once with texelFetch, and for each block row the texel
+     of A, accumulating a.x*b0+a.y*b1+a.z*b2+a.w*b3. Block row r goes to
+     render target r (rows of them, each ceil(m/rows) tall), and a copy
+     pass interleaves them into C. unroll texels of K are done per loop
+     iteration. benchmark/gemm.cpp sweeps both.
+*/
+class glGemm : public glPasses
+{
+
+public:
+
+    /*
+        rows is 1 to 4, the render targets a pass writes.
+
+        The defaults are provisional, the block shape and unroll sweep in
+         benchmark/gemm.cpp has not been run against this kernel yet. 4x4
+         fetches B least per output element, unroll 2 was the fastest
+         for the earlier 1x4 kernel. Pick them from benchmark_gemm on the
+         target hardware.
+    */
+    glGemm(unsigned unroll = 2, unsigned rows = 4)
+    : unroll(std::max(1u, unroll)), rows(std::min(std::max(1u, rows), 4u))
+    {}
+
+    // host matrices, C is read when beta is not 0 and overwritten
+    void multiply
+    (
+        uint64_t m,
+        uint64_t n,
+        uint64_t k,
+        float alpha,
+        const float * A,
+        const float * B,
+        float beta,
+        float * C
+    )
+    {
+        uint64_t kt = (k+3)/4;
+        uint64_t nt = (n+3)/4;
+        GLuint a = texture(kt, m, glFormat::RGBA32F, 0);
+        GLuint b = texture(nt, k, glFormat::RGBA32F, 1);
+        GLuint c = texture(nt, m, glFormat::RGBA32F, 2);
+
+        upload(a, A, m, k);
+        upload(b, B, k, n);
+        if (beta != 0.0f)
+        {
+            upload(c, C, m, n);
+        }
+
+        multiply(m, n, k, alpha, a, b, beta, c);
+
+        // c is still the frame buffer's attachment
+        begin();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, c, 0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        if (n % 4 == 0)
+        {
+            glReadPixels(0, 0, nt, m, GL_RGBA, GL_FLOAT, C);
+        }
+        else
+        {
+            std::vector<float> padded(nt*4*m);
+            glReadPixels(0, 0, nt, m, GL_RGBA, GL_FLOAT, padded.data());
+            for (uint64_t row = 0; row < m; row++)
+            {
+                std::copy(padded.begin()+row*nt*4, padded.begin()+row*nt*4+n, C+row*n);
+            }
+        }
+        end();
+    }
+
+    /*
+        Textures in the packed layout, ceil(k/4) x m for A, ceil(n/4) x k
+         for B and ceil(n/4) x m for C, which receives the result.
+    */
+    void multiply
+    (
+        uint64_t m,
+        uint64_t n,
+        uint64_t k,
+        float alpha,
+        GLuint A,
+        GLuint B,
+        float beta,
+        GLuint C
+    )
+    {
+        uint64_t nt = (n+3)/4;
+        uint64_t blocks = (m+rows-1)/rows;
+        std::vector<GLuint> results;
+        for (unsigned r = 0; r < rows; r++)
+        {
+            results.push_back(texture(nt, blocks, glFormat::RGBA32F, 3+r));
+        }
+
+        glShader & shader = program();
+        shader.use();
+        shader.setUniform("glc_a", Sampler2D(0));
+        shader.setUniform("glc_b", Sampler2D(1));
+        shader.setUniform("glc_c", Sampler2D(2));
+        shader.setUniform("glc_alpha", alpha);
+        shader.setUniform("glc_beta", beta);
+        shader.setUniform("glc_k", int(k));
+        shader.setUniform("glc_m", int(m));
+
+        begin();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, A);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, B);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, C);
+        draw(results, nt, blocks);
+
+        // interleave the block rows back, C cannot be read and drawn at once
+        glShader & copy = copyProgram();
+        copy.use();
+        for (unsigned r = 0; r < rows; r++)
+        {
+            copy.setUniform("glc_input"+std::to_string(r), Sampler2D(int(r)));
+            glActiveTexture(GL_TEXTURE0+r);
+            glBindTexture(GL_TEXTURE_2D, results[r]);
+        }
+        draw(C, nt, m);
+        end();
+    }
+
+private:
+
+    unsigned unroll, rows;
+    std::unique_ptr<glShader> shader, copyShader;
+
+    // rows x columns row major data into a packed texture, zero padded
+    void upload(GLuint texture, const float * data, uint64_t rows, uint64_t columns)
+    {
+        uint64_t texels = (columns+3)/4;
+        if (columns % 4 == 0)
+        {
+            transferToTexture2D(texture, data, texels, rows, glFormat::RGBA32F);
+            return;
+        }
+        std::vector<float> padded(texels*4*rows, 0.0f);
+        for (uint64_t row = 0; row < rows; row++)
+        {
+            std::copy(data+row*columns, data+(row+1)*columns, padded.begin()+row*texels*4);
+        }
+        transferToTexture2D(texture, padded.data(), texels, rows, glFormat::RGBA32F);
+    }
+
+    glShader & program()
+    {
+        if (shader == nullptr)
+        {
+            std::string block = "", accumulate = "", write = "";
+            for (unsigned r = 0; r < rows; r++)
+            {
+                std::string i = std::to_string(r);
+                block +=
+                    "layout(location = "+i+") out vec4 o_value"+i+";\n";
+                accumulate +=
+                    "           vec4 a"+i+" = texelFetch(glc_a, ivec2(t+u, min(row+"+i+", lastRow)), 0);\n"
+                    "           sum"+i+" += a"+i+".x*b0+a"+i+".y*b1+a"+i+".z*b2+a"+i+".w*b3;\n";
+                write +=
+                    "   o_value"+i+" = glc_alpha*sum"+i+"+(glc_beta == 0.0 ? vec4(0.0) : "
+                    "glc_beta*texelFetch(glc_c, ivec2(p.x, min(row+"+i+", lastRow)), 0));\n";
+            }
+            std::string sums = "";
+            for (unsigned r = 0; r < rows; r++)
+            {
+                sums += "   vec4 sum"+std::to_string(r)+" = vec4(0.0);\n";
+            }
+            std::string fragment =
+                "#version " GLSL_VERSION "\n"
+                "precision highp float;\n"
+                "precision highp int;\n"
+                "uniform highp sampler2D glc_a;\n"
+                "uniform highp sampler2D glc_b;\n"
+                "uniform highp sampler2D glc_c;\n"
+                "uniform float glc_alpha;\n"
+                "uniform float glc_beta;\n"
+                "uniform int glc_k;\n"
+                "uniform int glc_m;\n"
+                + block +
+                "void main(){\n"
+                "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+                "   int row = p.y*"+std::to_string(rows)+";\n"
+                "   int texels = (glc_k+3)/4;\n"
+                "   int last = glc_k-1;\n"
+                "   // rows past m are computed from clamped fetches and not copied back\n"
+                "   int lastRow = glc_m-1;\n"
+                + sums +
+                "   for (int t = 0; t < texels; t += "+std::to_string(unroll)+"){\n"
+                "       for (int u = 0; u < "+std::to_string(unroll)+"; u++){\n"
+                "           if (t+u >= texels) { break; }\n"
+                "           int r = (t+u)*4;\n"
+                "           // rows past k meet zero padding in a, clamp to stay finite\n"
+                "           vec4 b0 = texelFetch(glc_b, ivec2(p.x, r), 0);\n"
+                "           vec4 b1 = texelFetch(glc_b, ivec2(p.x, min(r+1, last)), 0);\n"
+                "           vec4 b2 = texelFetch(glc_b, ivec2(p.x, min(r+2, last)), 0);\n"
+                "           vec4 b3 = texelFetch(glc_b, ivec2(p.x, min(r+3, last)), 0);\n"
+                + accumulate +
+                "       }\n"
+                "   }\n"
+                + write +
+                "}";
+            shader = std::make_unique<glShader>(vertexShader, fragment.c_str());
+            shader->compile();
+        }
+        return *shader;
+    }
+
+    // row y of C is row y/rows of block row y%rows's target
+    glShader & copyProgram()
+    {
+        if (copyShader == nullptr)
+        {
+            std::string samplers = "", select = "";
+            for (unsigned r = 0; r < rows; r++)
+            {
+                std::string i = std::to_string(r);
+                samplers += "uniform highp sampler2D glc_input"+i+";\n";
+                select += r+1 < rows ?
+                    "   if (b == "+i+"){ o_value = texelFetch(glc_input"+i+", q, 0); return; }\n" :
+                    "   o_value = texelFetch(glc_input"+i+", q, 0);\n";
+            }
+            std::string fragment =
+                "#version " GLSL_VERSION "\n"
+                "precision highp float;\n"
+                "precision highp int;\n"
+                + samplers +
+                "layout(location = 0) out vec4 o_value;\n"
+                "void main(){\n"
+                "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+                "   int b = p.y % "+std::to_string(rows)+";\n"
+                "   ivec2 q = ivec2(p.x, p.y / "+std::to_string(rows)+");\n"
+                + select +
+                "}";
+            copyShader = std::make_unique<glShader>(vertexShader, fragment.c_str());
+            copyShader->compile();
+        }
+        return *copyShader;
+    }
+};
+
+/*
+    Radix-2 Stockham FFTs of complex data held as RG32F textures (re, im),
+     batched along rows, or in 2D (rows then columns). Sizes along a
+     transformed axis must be powers of two.
+
+    Stockham passes read and write different textures, so no bit
+     reversal pass is needed: pass p (p = 1, 2, 4, ..., N/2) gives each
+     output j the butterfly of inputs i = (j/2p)p+j%p and i+N/2 with
+     twiddle exp(-i pi (j%p)/p), looked up in a texture of the N/2
+     twiddles for that length. log2(N) passes per axis ping-pong against
+     a scratch texture, plus a copy when the count is odd. Inverse
+     transforms conjugate the twiddles and scale by 1/N.
+*/
+class glFFT : public glPasses
+{
+
+public:
+
+    ~glFFT()
+    {
+        for (auto & t : twiddles)
+        {
+            glDeleteTextures(1, &t.second);
+        }
+    }
+
+    // batched 1D transforms of the rows of an n x m texture, in place
+    void transformRows(GLuint data, uint64_t n, uint64_t m, bool inverse = false)
+    {
+        transform(data, n, m, inverse, false);
+    }
+
+    void transform2D(GLuint data, uint64_t n, uint64_t m, bool inverse = false)
+    {
+        transform(data, n, m, inverse, true);
+    }
+
+    // host data, n x m complex values interleaved (re, im) row by row
+    void transformRows(std::vector<float> & data, uint64_t n, uint64_t m, bool inverse = false)
+    {
+        transform(data, n, m, inverse, false);
+    }
+
+    void transform2D(std::vector<float> & data, uint64_t n, uint64_t m, bool inverse = false)
+    {
+        transform(data, n, m, inverse, true);
+    }
+
+private:
+
+    std::unique_ptr<glShader> shader;
+    std::map<uint64_t, GLuint> twiddles;
+
+    void transform(std::vector<float> & data, uint64_t n, uint64_t m, bool inverse, bool columns)
+    {
+        if (data.size() != 2*n*m)
+        {
+            throw std::runtime_error("glFFT: data is not n x m complex values");
+        }
+        GLuint values = texture(n, m, glFormat::RG32F, 1);
+        transferToTexture2D(values, data.data(), n, m, glFormat::RG32F);
+        transform(values, n, m, inverse, columns);
+        begin();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, values, 0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, n, m, GL_RG, GL_FLOAT, data.data());
+        end();
+    }
+
+    void transform(GLuint data, uint64_t n, uint64_t m, bool inverse, bool columns)
+    {
+        auto power = [](uint64_t x) { return x > 0 && (x & (x-1)) == 0; };
+        if (!power(n) || (columns && !power(m)))
+        {
+            throw std::runtime_error("glFFT: sizes must be powers of two");
+        }
+
+        // {axis, span} of each pass, span 0 copies
+        std::vector<std::pair<int, uint64_t>> passes;
+        for (uint64_t span = 1; span < n; span *= 2)
+        {
+            passes.push_back({0, span});
+        }
+        for (uint64_t span = 1; columns && span < m; span *= 2)
+        {
+            passes.push_back({1, span});
+        }
+        if (passes.size() % 2 == 1)
+        {
+            passes.push_back({0, 0});
+        }
+
+        if (shader == nullptr)
+        {
+            shader = std::make_unique<glShader>(vertexShader, fragment);
+            shader->compile();
+        }
+        GLuint rowTwiddles = twiddle(n);
+        GLuint columnTwiddles = columns ? twiddle(m) : 0;
+
+        shader->use();
+        shader->setUniform("glc_input", Sampler2D(0));
+        shader->setUniform("glc_twiddles", Sampler2D(1));
+        shader->setUniform("glc_direction", inverse ? -1.0f : 1.0f);
+        begin();
+
+        GLuint from = data;
+        GLuint to = texture(n, m, glFormat::RG32F, 0);
+        for (uint64_t pass = 0; pass < passes.size(); pass++)
+        {
+            int axis = passes[pass].first;
+            uint64_t span = passes[pass].second;
+            uint64_t length = axis == 0 ? n : m;
+            bool last = span*2 == length;
+            shader->setUniform("glc_axis", axis);
+            shader->setUniform("glc_span", int(span));
+            shader->setUniform("glc_length", int(length));
+            shader->setUniform("glc_scale", inverse && last ? 1.0f/float(length) : 1.0f);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, axis == 0 ? rowTwiddles : columnTwiddles);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, from);
+            draw(to, n, m);
+            std::swap(from, to);
+        }
+
+        end();
+    }
+
+    // the n/2 twiddles exp(-2 pi i t/n) of length n transforms
+    GLuint twiddle(uint64_t n)
+    {
+        if (twiddles.find(n) == twiddles.end())
+        {
+            uint64_t half = std::max(n/2, uint64_t(1));
+            std::vector<float> w(2*half);
+            for (uint64_t t = 0; t < half; t++)
+            {
+                double angle = -2.0*std::acos(-1.0)*double(t)/double(n);
+                w[2*t] = float(std::cos(angle));
+                w[2*t+1] = float(std::sin(angle));
+            }
+            GLuint texture;
+            glGenTextures(1, &texture);
+            initTexture2D(texture, half, 1, glFormat::RG32F);
+            transferToTexture2D(texture, w.data(), half, 1, glFormat::RG32F);
+            twiddles[n] = texture;
+        }
+        return twiddles[n];
+    }
+
+    const char * fragment =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "uniform highp sampler2D glc_input;\n"
+        "uniform highp sampler2D glc_twiddles;\n"
+        "uniform int glc_axis;\n"
+        "uniform int glc_span;\n"
+        "uniform int glc_length;\n"
+        "uniform float glc_direction;\n"
+        "uniform float glc_scale;\n"
+        "layout(location = 0) out vec4 o_value;\n"
+        "void main(){\n"
+        "   ivec2 p = ivec2(gl_FragCoord.xy);\n"
+        "   if (glc_span == 0){\n"
+        "       o_value = texelFetch(glc_input, p, 0);\n"
+        "       return;\n"
+        "   }\n"
+        "   int j = glc_axis == 0 ? p.x : p.y;\n"
+        "   int k = j & (glc_span-1);\n"
+        "   int i = (j/(2*glc_span))*glc_span+k;\n"
+        "   int h = glc_length/2;\n"
+        "   ivec2 a = glc_axis == 0 ? ivec2(i, p.y) : ivec2(p.x, i);\n"
+        "   ivec2 b = glc_axis == 0 ? ivec2(i+h, p.y) : ivec2(p.x, i+h);\n"
+        "   vec2 u0 = texelFetch(glc_input, a, 0).rg;\n"
+        "   vec2 u1 = texelFetch(glc_input, b, 0).rg;\n"
+        "   vec2 w = texelFetch(glc_twiddles, ivec2(k*(h/glc_span), 0), 0).rg;\n"
+        "   w.y *= glc_direction;\n"
+        "   vec2 t = vec2(u1.x*w.x-u1.y*w.y, u1.x*w.y+u1.y*w.x);\n"
+        "   vec2 v = ((j/glc_span) & 1) == 0 ? u0+t : u0-t;\n"
+        "   o_value = vec4(v*glc_scale, 0.0, 0.0);\n"
+        "}";
+};
+
+/*
+    Stencils (correlations) of float textures with a width x height kernel
+     of weights, out(x, y) = sum w[j][i] in(x+i-width/2, y+j-height/2),
+     with w row major. Samples outside the texture follow the boundary,
+     set with a sampler object so the input texture is left as it was.
+
+    Rank one (separable) kernels w[j][i] = c[j] r[i] are detected and
+     run as a row pass then a column pass through a scratch texture, so
+     each output costs width+height samples instead of width*height.
+     Kernel weights live in small R32F textures read by texelFetch.
+*/
+class glStencil : public glPasses
+{
+
+public:
+
+    glStencil
+    (
+        const std::vector<float> & weights,
+        uint64_t width,
+        uint64_t height,
+        glBoundary boundary = glBoundary::Clamp,
+        float constant = 0.0f
+    )
+    : width(width), height(height)
+    {
+        if (width == 0 || height == 0 || weights.size() != width*height)
+        {
+            throw std::runtime_error("glStencil: weights are not width x height");
+        }
+        std::vector<float> row, column;
+        if (separate(weights, row, column))
+        {
+            kernels.push_back(kernel(row, width, 1, constant));
+            kernels.push_back(kernel(column, 1, height, sum(row)*constant));
+        }
+        else
+        {
+            kernels.push_back(kernel(weights, width, height, constant));
+        }
+        initSampler(boundary);
+    }
+
+    // an explicitly separable kernel, w[j][i] = column[j] row[i]
+    glStencil
+    (
+        const std::vector<float> & row,
+        const std::vector<float> & column,
+        glBoundary boundary = glBoundary::Clamp,
+        float constant = 0.0f
+    )
+    : width(row.size()), height(column.size())
+    {
+        if (width == 0 || height == 0)
+        {
+            throw std::runtime_error("glStencil: empty kernel");
+        }
+        kernels.push_back(kernel(row, width, 1, constant));
+        kernels.push_back(kernel(column, 1, height, sum(row)*constant));
+        initSampler(boundary);
+    }
+
+    ~glStencil()
+    {
+        for (auto & k : kernels)
+        {
+            glDeleteTextures(1, &k.weights);
+        }
+        glDeleteSamplers(1, &sampler);
+    }
+
+    bool separable() const { return kernels.size() == 2; }
+
+    // input and output are n x m textures of a float format
+    void apply(GLuint input, GLuint output, uint64_t n, uint64_t m, glFormat format = glFormat::R32F)
+    {
+        if (formatInfo(format).type != GL_FLOAT && formatInfo(format).type != GL_HALF_FLOAT)
+        {
+            throw std::runtime_error("glStencil: only float formats can be filtered");
+        }
+        if (input == output)
+        {
+            throw std::runtime_error("glStencil: input and output must differ");
+        }
+
+        if (shader == nullptr)
+        {
+            shader = std::make_unique<glShader>(vertexShader, fragment);
+            shader->compile();
+        }
+        shader->use();
+        shader->setUniform("glc_input", Sampler2D(0));
+        shader->setUniform("glc_weights", Sampler2D(1));
+        shader->setUniform("glc_size", glm::vec2(n, m));
+        begin();
+        glBindSampler(0, sampler);
+
+        GLuint from = input;
+        for (uint64_t pass = 0; pass < kernels.size(); pass++)
+        {
+            GLuint to = pass+1 == kernels.size() ? output : texture(n, m, format, 0);
+            shader->setUniform("glc_width", int(kernels[pass].width));
+            shader->setUniform("glc_height", int(kernels[pass].height));
+#ifndef ANDROID
+            float border[4] = {kernels[pass].border, kernels[pass].border, kernels[pass].border, kernels[pass].border};
+            glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, border);
+#endif
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, kernels[pass].weights);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, from);
+            draw(to, n, m);
+            from = to;
+        }
+
+        glBindSampler(0, 0);
+        end();
+    }
+
+    // host data, n x m values of one channel
+    void apply(std::vector<float> & data, uint64_t n, uint64_t m)
+    {
+        if (data.size() != n*m)
+        {
+            throw std::runtime_error("glStencil: data is not n x m values");
+        }
+        GLuint input = texture(n, m, glFormat::R32F, 1);
+        GLuint output = texture(n, m, glFormat::R32F, 2);
+        transferToTexture2D(input, data.data(), n, m, glFormat::R32F);
+        apply(input, output, n, m);
+        begin();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, n, m, GL_RED, GL_FLOAT, data.data());
+        end();
+    }
+
+private:
+
+    struct Kernel
+    {
+        GLuint weights;
+        uint64_t width;
+        uint64_t height;
+        // outside the input of a column pass lies the row pass of a
+        //  constant boundary, sum(row) times the constant
+        float border;
+    };
+
+    uint64_t width, height;
+    std::vector<Kernel> kernels;
+    GLuint sampler;
+    std::unique_ptr<glShader> shader;
+
+    Kernel kernel(const std::vector<float> & weights, uint64_t w, uint64_t h, float border)
+    {
+        Kernel k = {0, w, h, border};
+        glGenTextures(1, &k.weights);
+        initTexture2D(k.weights, w, h, glFormat::R32F);
+        transferToTexture2D(k.weights, weights.data(), w, h, glFormat::R32F);
+        return k;
+    }
+
+    static float sum(const std::vector<float> & weights)
+    {
+        float total = 0.0f;
+        for (float w : weights)
+        {
+            total += w;
+        }
+        return total;
+    }
+
+    // nearest texels, texture() coordinates are texel centres
+    void initSampler(glBoundary boundary)
+    {
+        GLenum wrap = boundaryWrap(boundary);
+        glGenSamplers(1, &sampler);
+        glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, wrap);
+        glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, wrap);
+    }
+
+    // factor weights as column x row when it has rank one, scaled from
+    //  the largest weight, 1D kernels are trivially separable but gain
+    //  nothing from two passes
+    bool separate(const std::vector<float> & weights, std::vector<float> & row, std::vector<float> & column) const
+    {
+        if (width == 1 || height == 1)
+        {
+            return false;
+        }
+        uint64_t pivot = 0;
+        for (uint64_t i = 0; i < weights.size(); i++)
+        {
+            if (std::fabs(weights[i]) > std::fabs(weights[pivot]))
+            {
+                pivot = i;
+            }
+        }
+        float largest = weights[pivot];
+        if (largest == 0.0f)
+        {
+            return false;
+        }
+        uint64_t pi = pivot % width, pj = pivot / width;
+        row.assign(weights.begin()+pj*width, weights.begin()+(pj+1)*width);
+        column.resize(height);
+        for (uint64_t j = 0; j < height; j++)
+        {
+            column[j] = weights[j*width+pi]/largest;
+        }
+        for (uint64_t j = 0; j < height; j++)
+        {
+            for (uint64_t i = 0; i < width; i++)
+            {
+                if (std::fabs(column[j]*row[i]-weights[j*width+i]) > 1e-6f*std::fabs(largest))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const char * fragment =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "uniform highp sampler2D glc_input;\n"
+        "uniform highp sampler2D glc_weights;\n"
+        "uniform vec2 glc_size;\n"
+        "uniform int glc_width;\n"
+        "uniform int glc_height;\n"
+        "layout(location = 0) out vec4 o_value;\n"
+        "void main(){\n"
+        "   vec2 origin = gl_FragCoord.xy-vec2(float(glc_width/2), float(glc_height/2));\n"
+        "   vec4 sum = vec4(0.0);\n"
+        "   for (int j = 0; j < glc_height; j++){\n"
+        "       for (int i = 0; i < glc_width; i++){\n"
+        "           float w = texelFetch(glc_weights, ivec2(i, j), 0).r;\n"
+        "           sum += w*texture(glc_input, (origin+vec2(float(i), float(j)))/glc_size);\n"
+        "       }\n"
+        "   }\n"
+        "   o_value = sum;\n"
+        "}";
+};
+
+enum class glBlend {Add, Min, Max};
+
+/*
+    Scatters on the gpu: one GL_POINTS primitive per input element, placed
+     by its vertex shader at the element's output index, with blending
+     (GL_FUNC_ADD, GL_MIN or GL_MAX) combining elements that land on the
+     same texel. Scatter-add, reduce by key and histograms are scatters.
+
+    Inputs are the first elements texels, row by row, of n wide textures,
+     outputs are R32F textures indexed row by row. Elements whose index
+     is outside the output are dropped. Sums of counts are exact up to
+     2^24.
+*/
+class glScatter : public glPasses
+{
+
+public:
+
+    /*
+        output[keys[i]] = blend(output[keys[i]], values[i]) for R32UI keys
+         and R32F values, values = 0 scatters 1 per element (counts).
+         Unless accumulate, output starts at the blend's identity.
+    */
+    void scatter
+    (
+        GLuint keys,
+        GLuint values,
+        uint64_t n,
+        uint64_t elements,
+        GLuint output,
+        uint64_t outN,
+        uint64_t outM,
+        glBlend blend = glBlend::Add,
+        bool accumulate = false
+    )
+    {
+        prepare(n, outN, outM, outN*outM);
+        shader->setUniform("glc_mode", values == 0 ? 0 : 1);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, values);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, keys);
+        points(elements, output, outN, outM, blend, accumulate);
+    }
+
+    // counts of the R32F data in bins equal bins of [lo, hi), the first
+    //  bins texels of the output
+    void histogram
+    (
+        GLuint data,
+        uint64_t n,
+        uint64_t elements,
+        float lo,
+        float hi,
+        uint64_t bins,
+        GLuint output,
+        uint64_t outN,
+        uint64_t outM,
+        bool accumulate = false
+    )
+    {
+        if (!(hi > lo) || bins == 0 || bins > outN*outM)
+        {
+            throw std::runtime_error("glScatter: empty histogram range or bins not in the output");
+        }
+        prepare(n, outN, outM, bins);
+        shader->setUniform("glc_mode", 2);
+        shader->setUniform("glc_range", glm::vec2(lo, hi));
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, data);
+        glActiveTexture(GL_TEXTURE0);
+        points(elements, output, outN, outM, glBlend::Add, accumulate);
+    }
+
+    // host data, returns length outputs (the blend's identity where no key lands)
+    std::vector<float> scatter
+    (
+        const std::vector<uint32_t> & keys,
+        const std::vector<float> & values,
+        uint64_t length,
+        glBlend blend = glBlend::Add
+    )
+    {
+        if (!values.empty() && values.size() != keys.size())
+        {
+            throw std::runtime_error("glScatter: keys and values differ in length");
+        }
+        auto in = linearLayout(keys.size());
+        GLuint k = texture(in.first, in.second, glFormat::R32UI, 1);
+        GLuint v = 0;
+        upload(k, keys.data(), in.first, keys.size(), glFormat::R32UI);
+        if (!values.empty())
+        {
+            v = texture(in.first, in.second, glFormat::R32F, 1);
+            upload(v, values.data(), in.first, values.size(), glFormat::R32F);
+        }
+        auto out = linearLayout(length);
+        GLuint o = texture(out.first, out.second, glFormat::R32F, 2);
+        scatter(k, v, in.first, keys.size(), o, out.first, out.second, blend);
+        return read(o, out, length);
+    }
+
+    std::vector<float> histogram(const std::vector<float> & data, float lo, float hi, uint64_t bins)
+    {
+        auto in = linearLayout(data.size());
+        GLuint d = texture(in.first, in.second, glFormat::R32F, 1);
+        upload(d, data.data(), in.first, data.size(), glFormat::R32F);
+        return histogram(d, in.first, data.size(), lo, hi, bins);
+    }
+
+    // bins counts of a texture's data, read back
+    std::vector<float> histogram(GLuint data, uint64_t n, uint64_t elements, float lo, float hi, uint64_t bins)
+    {
+        auto out = linearLayout(bins);
+        GLuint o = texture(out.first, out.second, glFormat::R32F, 2);
+        histogram(data, n, elements, lo, hi, bins, o, out.first, out.second);
+        return read(o, out, bins);
+    }
+
+private:
+
+    std::unique_ptr<glShader> shader;
+
+    void prepare(uint64_t n, uint64_t outN, uint64_t outM, uint64_t length)
+    {
+        if (n == 0 || outN == 0 || outM == 0)
+        {
+            throw std::runtime_error("glScatter: empty input or output");
+        }
+        if (shader == nullptr)
+        {
+            shader = std::make_unique<glShader>(vertex, fragment);
+            shader->compile();
+        }
+        shader->use();
+        shader->setUniform("glc_keys", Sampler2D(0));
+        shader->setUniform("glc_values", Sampler2D(1));
+        shader->setUniform("glc_width", int(n));
+        shader->setUniform("glc_size", glm::vec2(outN, outM));
+        shader->setUniform("glc_length", int(length));
+    }
+
+    void points(uint64_t elements, GLuint output, uint64_t outN, uint64_t outM, glBlend blend, bool accumulate)
+    {
+        begin();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+        glViewport(0, 0, outN, outM);
+        if (!accumulate)
+        {
+            float identity = blend == glBlend::Min ? INFINITY : blend == glBlend::Max ? -INFINITY : 0.0f;
+            float clear[4] = {identity, identity, identity, identity};
+            glClearBufferfv(GL_COLOR, 0, clear);
+        }
+        glEnable(GL_BLEND);
+        glBlendEquation(blend == glBlend::Min ? GL_MIN : blend == glBlend::Max ? GL_MAX : GL_FUNC_ADD);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDrawArrays(GL_POINTS, 0, elements);
+        glDisable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        end();
+    }
+
+    // linearly laid out data, the last row may be partial
+    void upload(GLuint id, const void * data, uint64_t n, uint64_t elements, glFormat format)
+    {
+        uint64_t row = elements/n;
+        transferRowsToTexture2D(id, data, n, 0, row, format);
+        if (elements % n != 0)
+        {
+            glBindTexture(GL_TEXTURE_2D, id);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glFormatInfo info = formatInfo(format);
+            glTexSubImage2D
+            (
+                GL_TEXTURE_2D, 0, 0, row, elements % n, 1, info.format, info.type,
+                static_cast<const uint8_t*>(data)+row*n*info.texelBytes()
+            );
+        }
+    }
+
+    std::vector<float> read(GLuint output, std::pair<uint64_t, uint64_t> size, uint64_t length)
+    {
+        std::vector<float> values(size.first*size.second);
+        begin();
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output, 0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, size.first, size.second, GL_RED, GL_FLOAT, values.data());
+        end();
+        values.resize(length);
+        return values;
+    }
+
+    // modes 0: scatter counts, 1: scatter values, 2: histogram of values
+    const char * vertex =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "uniform highp usampler2D glc_keys;\n"
+        "uniform highp sampler2D glc_values;\n"
+        "uniform int glc_mode;\n"
+        "uniform int glc_width;\n"
+        "uniform vec2 glc_size;\n"
+        "uniform int glc_length;\n"
+        "uniform vec2 glc_range;\n"
+        "flat out float glc_value;\n"
+        "void main(){\n"
+        "   ivec2 p = ivec2(gl_VertexID % glc_width, gl_VertexID / glc_width);\n"
+        "   uint bins = uint(glc_length);\n"
+        "   uint key = bins;\n"
+        "   glc_value = 1.0;\n"
+        "   if (glc_mode == 2){\n"
+        "       float v = texelFetch(glc_values, p, 0).r;\n"
+        "       if (v >= glc_range.x && v < glc_range.y){\n"
+        "           float bin = floor((v-glc_range.x)/(glc_range.y-glc_range.x)*float(bins));\n"
+        "           key = min(uint(bin), bins-1u);\n"
+        "       }\n"
+        "   }\n"
+        "   else{\n"
+        "       key = texelFetch(glc_keys, p, 0).r;\n"
+        "       if (glc_mode == 1){\n"
+        "           glc_value = texelFetch(glc_values, p, 0).r;\n"
+        "       }\n"
+        "   }\n"
+        "   gl_PointSize = 1.0;\n"
+        "   if (key >= bins){\n"
+        "       gl_Position = vec4(2.0, 2.0, 0.0, 1.0);\n"
+        "       return;\n"
+        "   }\n"
+        "   vec2 texel = vec2(float(key % uint(glc_size.x)), float(key / uint(glc_size.x)));\n"
+        "   gl_Position = vec4((texel+0.5)/glc_size*2.0-1.0, 0.0, 1.0);\n"
+        "}";
+
+    const char * fragment =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "flat in float glc_value;\n"
+        "layout(location = 0) out vec4 o_value;\n"
+        "void main(){\n"
+        "   o_value = vec4(glc_value);\n"
+        "}";
+};
+
+class glCompute
+{
+
+public:
+
+    glShader shader;
+
+    const char * vertexShader =
+        "#version " GLSL_VERSION "\n"
+        "precision highp float;\n"
+        "precision highp int;\n"
+        "layout(location = 0) in vec4 a_position;\n"
+        "out vec2 o_texCoords;\n"
+        "void main(){\n"
+        "   gl_Position = vec4(a_position.xy,0.0,1.0);\n"
+        "   o_texCoords = a_position.zw;\n"
+        "}";
+
+    /*
+        How attribute data reaches the gpu on sync
+
+        Blocking:    glTexSubImage2D straight from the host data, the cpu
+                      waits for the driver to consume it
+
+        PixelBuffer: the host data is staged in a ring of pixel unpack
+                      buffers and copied to the texture by the gpu, sync
+                      returns as soon as the data is staged
+
+        Persistent:  the host data and result live in persistently mapped
+                      buffers (GL 4.4 or ARB_buffer_storage), get() and
+                      result() point straight into them and fences keep
+                      the cpu and gpu from using them at the same time.
+                      Falls back to PixelBuffer where unsupported.
+    */
+    enum class Transfer {Blocking, PixelBuffer, Persistent};
+
+    static constexpr uint8_t PIXEL_BUFFER_RING = 3;
+
+    /*
+        Construction time choices, a Transfer converts to Options
+
+        packChannels: R32F attributes of the same size are packed, up to
+                       four at a time, into the channels of one RGBA32F
+                       texture. The shader's texture(x, ...),
+                       texelFetch(x, ...), textureSize(x, ...) and, for
+                       1D arrays, element(x, ...) calls are rewritten to generated accessors, so one
+                       texture unit and bind serves up to four attributes
+                       and the fetches can be shared. Packed attributes
+                       are interleaved on the host during sync.
+
+        vectorOutput: for an R32F output each fragment writes four
+                       consecutive elements of a row as one vec4, so the
+                       render target is RGBA32F and a quarter the width.
+                       The fragment shader has no main, instead it
+                       defines
+
+                         float kernel(ivec2 element, vec2 texCoords)
+
+                       returning one element, texCoords being the
+                       element's centre in [0,1]^2. main is generated.
+                       Results are unpacked to the logical n x m array
+                       on readback.
+
+        tileSize: outputs larger than this in either dimension are
+                   computed tile by tile, 0 means GL_MAX_TEXTURE_SIZE
+                   (which is also the upper limit). Attributes the size
+                   of the output are split into matching tiles, each
+                   bound under the attribute's name while its output
+                   tile is drawn, so element wise shaders work
+                   unchanged. o_texCoords spans the tile; the shader
+                   may declare
+
+                     uniform vec2 glc_tileOffset;
+                     uniform vec2 glc_tileSize;
+
+                   giving the tile's first element and size, and
+                   glc_size the logical output size. Other attributes
+                   must fit in one texture. Not available with
+                   vectorOutput. Tiling lifts the texture size limit
+                   only, every tile's textures (and the host data)
+                   stay resident at once, so arrays larger than gpu
+                   memory are not handled.
+
+        boundaries: per attribute, what texture() samples outside [0, 1)
+                     as (glBoundary, constant), for kernels sampling
+                     neighbours. Attributes not listed clamp to the
+                     edge. Wrap and Constant attributes are not packed
+                     and cannot be tiled. Textures bound from another
+                     glCompute keep their own boundary.
+
+        deferCompile: the constructor submits the shader without
+                       waiting for it to compile and link, the first
+                       run (or wait()) waits. Constructing many
+                       glComputes before running any overlaps their
+                       compiles where the driver supports
+                       KHR_parallel_shader_compile. Shader errors are
+                       thrown by that first run. isReady() only polls
+                       when glHasParallelShaderCompile(), otherwise it
+                       is always true and wait() blocks.
+    */
+    struct Options
+    {
+        Options(Transfer transfer = Transfer::Blocking)
+        : transfer(transfer)
+        {}
+
+        Transfer transfer;
+        bool packChannels = false;
+        bool vectorOutput = false;
+        uint64_t tileSize = 0;
+        bool deferCompile = false;
+        std::map<std::string, std::pair<glBoundary, float>> boundaries;
+    };
+
+    glCompute
+    (
+        std::map<std::string, std::pair<uint64_t, uint64_t>> attributeSize,
+        std::pair<uint64_t, uint64_t> outputSize,
+        const char * fragmentShader,
+        Options options = Options()
+    )
+    : glCompute(attributeSize, {}, outputSize, glFormat::R32F, fragmentShader, options)
+    {}
+
+    /*
+        1D arrays, each laid out by linearLayout. result() and get() view
+         just the length elements, without padding.
+
+        The shader gets the helpers
+
+          int index()               the output element of this fragment
+          int index(ivec2 element)  the output element at element, for
+                                     vectorOutput kernels
+          vec4 element(sampler2D s, int i)
+                                    element i of the attribute s, also
+                                     for isampler2D and usampler2D
+
+        Attributes of the output's length share its layout, so
+         texture(x, o_texCoords) also reads the matching element. When
+         the output is tiled (see Options::tileSize) those attributes are
+         split into tiles too. element() cannot reach elements outside
+         the bound tile, so using it on them throws at construction.
+    */
+    glCompute
+    (
+        std::map<std::string, uint64_t> attributeLength,
+        uint64_t outputLength,
+        const char * fragmentShader,
+        Options options = Options()
+    )
+    : glCompute(attributeLength, {}, outputLength, glFormat::R32F, fragmentShader, options)
+    {}
+
+    glCompute
+    (
+        std::map<std::string, uint64_t> attributeLength,
+        std::map<std::string, glFormat> attributeFormat,
+        uint64_t outputLength,
+        glFormat outputFormat,
+        const char * fragmentShader,
+        Options options = Options()
+    )
+    : glCompute
+      (
+        linearLayouts(attributeLength),
+        attributeFormat,
+        linearLayout(outputLength),
+        outputFormat,
+        linearSource(fragmentShader, linearLayout(outputLength).first).c_str(),
+        options
+      )
+    {
+        this->outputLength = std::max(outputLength, uint64_t(1));
+        for (auto & attr : attributeLength)
+        {
+            attributes[attr.first].length = attr.second;
+            std::regex indexed("\\belement\\s*\\(\\s*"+attr.first+"\\s*,");
+            if (attributes[attr.first].tiled && std::regex_search(fragmentShader, indexed))
+            {
+                throw std::runtime_error
+                (
+                    "glCompute: element("+attr.first+", i) on a tiled attribute, only its bound tile is sampled"
+                );
+            }
+        }
+    }
+
+    /*
+        Attributes named in attributeFormat use that format, the rest are
+         R32F. Any attribute the fragment shader does not declare gets a
+         sampler of the matching type (sampler2D, isampler2D or
+         usampler2D) declared for it.
+
+        The fragment shader's output should be the outputFormat's value
+         type, e.g. uint for R32UI or vec4 for RGBA32F.
+    */
+    glCompute
+    (
+        std::map<std::string, std::pair<uint64_t, uint64_t>> attributeSize,
+        std::map<std::string, glFormat> attributeFormat,
+        std::pair<uint64_t, uint64_t> outputSize,
+        glFormat outputFormat,
+        const char * fragmentShader,
+        Options options = Options()
+    )
+    : outputSize(outputSize),
+      outputFormat(outputFormat),
+      vectorOutput(options.vectorOutput),
+      targetSize
+      (
+        options.vectorOutput ?
+            std::pair<uint64_t, uint64_t>((outputSize.first+3)/4, outputSize.second) : outputSize
+      ),
+      targetFormat(options.vectorOutput ? glFormat::RGBA32F : outputFormat),
+      transfer
+      (
+        options.transfer == Transfer::Persistent && !glHasBufferStorage() ?
+            Transfer::PixelBuffer : options.transfer
+      )
+    {
+        if (vectorOutput && outputFormat != glFormat::R32F)
+        {
+            throw std::runtime_error("glCompute: vectorOutput needs an R32F output");
+        }
+
+        GLint maxSize;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+        uint64_t tileSize = options.tileSize == 0 ? maxSize : std::min(options.tileSize, uint64_t(maxSize));
+        for (uint64_t y = 0; y < targetSize.second; y += tileSize)
+        {
+            for (uint64_t x = 0; x < targetSize.first; x += tileSize)
+            {
+                tiles.push_back
+                (
+                    {
+                        x,
+                        y,
+                        std::min(tileSize, targetSize.first-x),
+                        std::min(tileSize, targetSize.second-y)
+                    }
+                );
+            }
+        }
+        if (tiles.size() > 1 && vectorOutput)
+        {
+            throw std::runtime_error("glCompute: vectorOutput cannot be tiled");
+        }
+        for (auto & attr : attributeSize)
+        {
+            bool fits = attr.second.first <= tileSize && attr.second.second <= tileSize;
+            if (!fits && attr.second != outputSize)
+            {
+                throw std::runtime_error
+                (
+                    "glCompute: attribute "+attr.first+" is larger than the tile size but not the output size"
+                );
+            }
+        }
+
+        auto formatOf = [&attributeFormat](const std::string & name)
+        {
+            auto format = attributeFormat.find(name);
+            return format == attributeFormat.end() ? glFormat::R32F : format->second;
+        };
+
+        // same sized R32F attributes in groups of up to four
+        std::vector<std::vector<std::string>> groups;
+        if (options.packChannels)
+        {
+            std::map<std::pair<uint64_t, uint64_t>, std::vector<std::string>> bySize;
+            for (auto & attr : attributeSize)
+            {
+                bool fits = attr.second.first <= tileSize && attr.second.second <= tileSize;
+                auto boundary = options.boundaries.find(attr.first);
+                bool clamped = boundary == options.boundaries.end() || boundary->second.first == glBoundary::Clamp;
+                if (formatOf(attr.first) == glFormat::R32F && fits && clamped)
+                {
+                    bySize[attr.second].push_back(attr.first);
+                }
+            }
+            for (auto & size : bySize)
+            {
+                for (uint64_t i = 0; i < size.second.size(); i += 4)
+                {
+                    std::vector<std::string> group
+                    (
+                        size.second.begin()+i,
+                        size.second.begin()+std::min(i+4, uint64_t(size.second.size()))
+                    );
+                    if (group.size() > 1)
+                    {
+                        groups.push_back(group);
+                    }
+                }
+            }
+        }
+
+        for (auto & attr : attributeSize)
+        {
+            attributes[attr.first] = Attribute
+            (
+                formatOf(attr.first),
+                0,
+                attr.second.first,
+                attr.second.second,
+                false
+            );
+            attributes[attr.first].tiled = tiles.size() > 1 && attr.second == outputSize;
+        }
+
+        for (auto & boundary : options.boundaries)
+        {
+            if (attributes.find(boundary.first) == attributes.end())
+            {
+                throw std::runtime_error("glCompute: boundary for unknown attribute "+boundary.first);
+            }
+            Attribute & attr = attributes[boundary.first];
+            if (attr.tiled && boundary.second.first != glBoundary::Clamp)
+            {
+                throw std::runtime_error("glCompute: attribute "+boundary.first+" is tiled, only Clamp boundaries apply");
+            }
+            attr.boundary = boundary.second.first;
+            attr.boundaryConstant = boundary.second.second;
+        }
+
+        for (uint64_t g = 0; g < groups.size(); g++)
+        {
+            std::string name = "glc_pack"+std::to_string(g);
+            for (uint8_t c = 0; c < groups[g].size(); c++)
+            {
+                attributes[groups[g][c]].pack = name;
+                attributes[groups[g][c]].channel = c;
+            }
+            const Attribute & first = attributes[groups[g][0]];
+            packs[name] = Attribute(glFormat::RGBA32F, 0, first.dimX, first.dimY, false);
+        }
+
+        for (auto & attr : attributes)
+        {
+            if (attr.second.pack.empty())
+            {
+                initAttribute(attr.second);
+            }
+        }
+
+        for (auto & pack : packs)
+        {
+            initAttribute(pack.second);
+        }
+
+        shader = glShader(vertexShader, generateSource(fragmentShader).c_str());
+        if (options.deferCompile)
+        {
+            shader.submit();
+        }
+        else
+        {
+            shader.compile();
+        }
+        shader.setUniform("glc_tileOffset", glm::vec2(0.0f));
+        shader.setUniform("glc_tileSize", glm::vec2(targetSize.first, targetSize.second));
+        shader.setUniform("glc_size", glm::vec2(outputSize.first, outputSize.second));
+
+        glFormatInfo info = formatInfo(targetFormat);
+        uint64_t outputElements = targetSize.first*targetSize.second*info.channels;
+        output = makeHostVector(targetFormat, outputElements);
+        outputTextures.resize(tiles.size());
+        glGenTextures(tiles.size(), outputTextures.data());
+        for (uint64_t t = 0; t < tiles.size(); t++)
+        {
+            const Tile & tile = tiles[t];
+            textures.push_back(outputTextures[t]);
+            initTexture2D(outputTextures[t], tile.width, tile.height, targetFormat);
+            transferTileRowsToTexture2D
+            (
+                outputTextures[t],
+                hostData(output),
+                targetSize.first,
+                tile.x,
+                tile.y,
+                tile.width,
+                tile.y,
+                tile.height,
+                targetFormat
+            );
+        }
+        if (transfer == Transfer::Persistent)
+        {
+            output = makeHostVector(targetFormat, 0);
+            glGenBuffers(1, &outputBuffer);
+            outputMapped = initPersistentBuffer
+            (
+                GL_PIXEL_PACK_BUFFER,
+                outputBuffer,
+                outputElements*info.channelBytes,
+                GL_MAP_READ_BIT | GL_MAP_WRITE_BIT
+            );
+            if (outputMapped == nullptr)
+            {
+                throw GLRuntimeException("glCompute: could not map the persistent output buffer");
+            }
+            std::memset(outputMapped, 0, outputElements*info.channelBytes);
+        }
+        glGenFramebuffers(1, &frameBuffer);
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData
+        (
+            GL_ARRAY_BUFFER,
+            sizeof(float)*6*4,
+            &quad[0],
+            GL_STATIC_DRAW
+        );
+        glAllocations()++;
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer
+        (
+            0,
+            4,
+            GL_FLOAT,
+            false,
+            4*sizeof(float),
+            0
+        );
+        glVertexAttribDivisor(0,0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    ~glCompute()
+    {
+        for (auto * group : {&attributes, &packs})
+        {
+            for (auto & attr : *group)
+            {
+                if (attr.second.pixelBuffers.size() > 0)
+                {
+                    glDeleteBuffers(attr.second.pixelBuffers.size(), attr.second.pixelBuffers.data());
+                }
+                releasePersistent(GL_PIXEL_UNPACK_BUFFER, attr.second.staging, attr.second.fence);
+            }
+        }
+        releasePersistent(GL_PIXEL_PACK_BUFFER, outputBuffer, outputFence);
+        glDeleteTextures(textures.size(), textures.data());
+        glDeleteFramebuffers(1, &frameBuffer);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    /*
+        Host data is set with the attribute format's element type (see
+         glFormat), float data is also accepted for R16F and converted
+         to half floats. Multi-channel data is interleaved.
+    */
+
+    void set(std::string attribute, const std::vector<float> & newData)
+    {
+        set(attribute, newData.data(), newData.size());
+    }
+
+    void set(std::string attribute, std::vector<float> && newData)
+    {
+        set<float>(attribute, std::move(newData));
+    }
+
+    template <class T>
+    void set(std::string attribute, const std::vector<T> & newData)
+    {
+        set(attribute, newData.data(), newData.size());
+    }
+
+    // takes the storage of newData when it is exactly the attribute's size
+    template <class T>
+    void set(std::string attribute, std::vector<T> && newData)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            if
+            (
+                attr.mapped == nullptr &&
+                std::holds_alternative<std::vector<T>>(attr.data) &&
+                newData.size() == attr.elements()
+            )
+            {
+                // a 1D attribute's padding
+                newData.resize(attr.size());
+                attr.data = std::move(newData);
+                attr.markDirty(0, attr.size());
+            }
+            else
+            {
+                set(attribute, newData.data(), newData.size());
+            }
+        }
+    }
+
+    // copy length elements from newData into the attribute, starting at offset
+    template <class T>
+    void set(std::string attribute, const T * newData, uint64_t length, uint64_t offset = 0)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            if (offset+length <= attr.size())
+            {
+                if constexpr (std::is_same<T, float>::value)
+                {
+                    if (attr.format == glFormat::R16F)
+                    {
+                        uint16_t * host = attr.template hostAs<uint16_t>();
+                        for (uint64_t i = 0; i < length; i++)
+                        {
+                            host[offset+i] = glm::packHalf1x16(newData[i]);
+                        }
+                        attr.markDirty(offset, offset+length);
+                        return;
+                    }
+                }
+                std::copy
+                (
+                    newData,
+                    newData+length,
+                    attr.template hostAs<T>()+offset
+                );
+                attr.markDirty(offset, offset+length);
+            }
+        }
+    }
+
+    // datum is converted to the attribute's element type
+    template <class T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+    void set(std::string attribute, T datum, uint64_t index)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            if (index < attr.size())
+            {
+                void * host = attr.host();
+                switch (formatInfo(attr.format).type)
+                {
+                    case GL_HALF_FLOAT:
+                        static_cast<uint16_t*>(host)[index] = glm::packHalf1x16(float(datum));
+                        break;
+                    case GL_INT:
+                        static_cast<int32_t*>(host)[index] = int32_t(datum);
+                        break;
+                    case GL_UNSIGNED_INT:
+                        static_cast<uint32_t*>(host)[index] = uint32_t(datum);
+                        break;
+                    default:
+                        static_cast<float*>(host)[index] = float(datum);
+                        break;
+                }
+                attr.markDirty(index, index+1);
+            }
+        }
+    }
+
+    /*
+        Writes through the view cannot be tracked, so the whole attribute
+         is uploaded on the next sync. T must be the attribute format's
+         element type.
+
+        With Transfer::Persistent the view is the mapped staging memory,
+         call get() again after a sync rather than keeping the view, get()
+         waits for the gpu to finish reading it.
+    */
+    template <class T = float>
+    ArrayView<T> get(std::string attribute)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            T * host = attr.template hostAs<T>();
+            attr.markDirty(0, attr.elements());
+            return ArrayView<T>(host, attr.elements());
+        }
+        throw std::runtime_error("No attribute: "+attribute);
+    }
+
+    // with Transfer::Persistent this waits for, and views, the mapped result
+    template <class T = float>
+    ArrayView<const T> result()
     {
-        std::regex UNIFORM_REGEX("uniform");
-        bool fragmentNoUniforms = false;
-        auto start = std::sregex_iterator(fragment.begin(), fragment.end(), UNIFORM_REGEX);
-        auto end = std::sregex_iterator();
-        if (std::distance(start, end) == 0)
+        if (!isHostType<T>(outputFormat))
+        {
+            throw std::runtime_error("result: element type does not match the output format");
+        }
+        uint64_t elements = outputElements();
+        if (outputMapped != nullptr)
+        {
+            if (outputFence != nullptr)
+            {
+                waitFence(outputFence);
+                glDeleteSync(outputFence);
+                outputFence = nullptr;
+            }
+            if (padded())
+            {
+                unpackOutput(outputMapped);
+                return ArrayView<const T>(static_cast<const T*>(hostData(output)), elements);
+            }
+            return ArrayView<const T>(static_cast<const T*>(outputMapped), elements);
+        }
+        return ArrayView<const T>(static_cast<const T*>(hostData(output)), elements);
+    }
+
+    void sync(std::string attribute)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            if (attr.pack.empty())
+            {
+                syncAttribute(attr);
+            }
+            else
+            {
+                syncPack(attr.pack);
+            }
+        }
+    }
+
+    void sync()
+    {
+        for (auto & attr : attributes)
+        {
+            if (attr.second.pack.empty())
+            {
+                syncAttribute(attr.second);
+            }
+        }
+        for (auto & pack : packs)
+        {
+            syncPack(pack.first);
+        }
+    }
+
+    /*
+        Upload length elements straight from data to the attribute's
+         texture, bypassing (and not updating) the host copy. T must be
+         the attribute format's element type.
+
+        Rows fully covered by data are no longer considered dirty, so a
+         later sync() will not overwrite them with the stale host copy.
+
+        A packed or tiled attribute's texture is not laid out as data,
+         so for those data is copied to the host copy and synced instead.
+    */
+    template <class T>
+    void sync(std::string attribute, const T * data, uint64_t length)
+    {
+        if (attributes.find(attribute) != attributes.end())
+        {
+            Attribute & attr = attributes[attribute];
+            if (length > attr.size())
+            {
+                return;
+            }
+            if (!attr.pack.empty() || attr.tiled)
+            {
+                set(attribute, data, length);
+                sync(attribute);
+                return;
+            }
+            if (!isHostType<T>(attr.format))
+            {
+                throw std::runtime_error("sync: element type does not match the format of attribute "+attribute);
+            }
+
+            settleFeedback(attr);
+
+            uint64_t rows = length / attr.rowElements();
+            uint64_t tail = (length % attr.rowElements()) / attr.channels();
+
+            if (rows > 0)
+            {
+                transferRowsToTexture2D(attr.texture, data, attr.dimX, 0, rows, attr.format);
+                std::fill(attr.dirtyRows.begin(), attr.dirtyRows.begin()+rows, 0);
+            }
+
+            if (tail > 0)
+            {
+                glFormatInfo info = formatInfo(attr.format);
+                glBindTexture(GL_TEXTURE_2D, attr.texture);
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glTexSubImage2D(
+                    GL_TEXTURE_2D,
+                    0,
+                    0,
+                    rows,
+                    tail,
+                    1,
+                    info.format,
+                    info.type,
+                    data+rows*attr.rowElements()
+                );
+            }
+
+            attr.dirty = std::find(attr.dirtyRows.begin(), attr.dirtyRows.end(), 1) != attr.dirtyRows.end();
+        }
+    }
+
+    // true when wait() would not block, see Options::deferCompile
+    bool isReady() { return shader.isReady(); }
+
+    // wait for a deferred compile, throwing any shader error
+    void wait() { shader.wait(); }
+
+    void compute(bool syncResult)
+    {
+        if (!feedback.empty())
+        {
+            // the last iterate step's output becomes its attribute
+            swapOutput(attributes[feedback]);
+            feedback.clear();
+        }
+
+        shader.use();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+
+        GLenum drawBuffers[1] = {GL_COLOR_ATTACHMENT0};
+        glDrawBuffers(1, drawBuffers);
+
+        // tiled attributes are rebound for each tile
+        std::vector<std::pair<GLuint, const Attribute *>> tiled;
+        GLuint t = 0;
+        for (auto * group : {&attributes, &packs})
+        {
+            for (const auto & attr : *group)
+            {
+                if (!attr.second.pack.empty())
+                {
+                    // sampled through its pack
+                    continue;
+                }
+                glActiveTexture(GL_TEXTURE0+t+2);
+                glBindTexture
+                (
+                    GL_TEXTURE_2D,
+                    attr.second.source == nullptr ?
+                        attr.second.texture : attr.second.source->outputTextures[0]
+                );
+                shader.setUniform(attr.first, Sampler2D(t+2));
+                if (attr.second.tiled)
+                {
+                    tiled.push_back({t+2, &attr.second});
+                }
+                t++;
+            }
+        }
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        glDepthMask(false);
+        glDisable(GL_BLEND);
+
+        for (uint64_t i = 0; i < tiles.size(); i++)
+        {
+            const Tile & tile = tiles[i];
+
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, outputTextures[i]);
+
+            glFramebufferTexture2D
+            (
+                GL_FRAMEBUFFER,
+                GL_COLOR_ATTACHMENT0,
+                GL_TEXTURE_2D,
+                outputTextures[i],
+                0
+            );
+
+            for (const auto & attr : tiled)
+            {
+                glActiveTexture(GL_TEXTURE0+attr.first);
+                glBindTexture(GL_TEXTURE_2D, attr.second->tiles[i]);
+            }
+
+            if (tiles.size() > 1)
+            {
+                shader.setUniform("glc_tileOffset", glm::vec2(tile.x, tile.y));
+                shader.setUniform("glc_tileSize", glm::vec2(tile.width, tile.height));
+            }
+
+            glViewport(0, 0, tile.width, tile.height);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+
+        if (syncResult && outputMapped != nullptr)
+        {
+            readPersistent();
+        }
+        else if (syncResult)
+        {
+            readOutput(hostData(output));
+            if (padded()) { unpackOutput(hostData(output)); }
+        }
+
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    template <class T = float>
+    ArrayView<const T> syncResult()
+    {
+        if (outputMapped != nullptr)
+        {
+            readPersistent();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            return result<T>();
+        }
+        readOutput(hostData(output));
+        if (padded()) { unpackOutput(hostData(output)); }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return result<T>();
+    }
+
+    /*
+        Run steps computations, each one reading the previous one's
+         output as attribute, without copying anything to the host
+         unless syncResult. The attribute's and output's textures swap
+         roles each step (ping-pong), so the attribute must match the
+         output's size and format, and not be packed or bound (unbind()
+         it first).
+
+        The output holds the last step's result, the attribute receives
+         it before the next compute or upload to it. Its host copy is not
+         updated, so rows changed on the host are uploaded over it.
+    */
+    void iterate(std::string attribute, uint64_t steps, bool syncResult = false)
+    {
+        if (attributes.find(attribute) == attributes.end())
+        {
+            throw std::runtime_error("No attribute: "+attribute);
+        }
+        const Attribute & attr = attributes[attribute];
+        if
+        (
+            attr.format != targetFormat ||
+            attr.dimX != targetSize.first ||
+            attr.dimY != targetSize.second ||
+            !attr.pack.empty()
+        )
+        {
+            throw std::runtime_error("iterate: attribute "+attribute+" does not match the output");
+        }
+        if (attr.source != nullptr)
+        {
+            // compute() samples the source's output, the swapped texture would be ignored
+            throw std::runtime_error("iterate: attribute "+attribute+" is bound");
+        }
+        for (uint64_t step = 0; step < steps; step++)
         {
-            fragmentNoUniforms = true;
+            compute(syncResult && step+1 == steps);
+            feedback = attribute;
         }
+    }
 
-        start = std::sregex_iterator(vertex.begin(), vertex.end(), UNIFORM_REGEX);
-        end = std::sregex_iterator();
-        if (std::distance(start, end) == 0)
+    /*
+        Sample source's output as attribute in the following computes,
+         in place of the attribute's own texture, so results feed other
+         glComputes without leaving the gpu. The attribute must match
+         source's output size and format; packed or tiled attributes and
+         tiled outputs cannot be bound. source must outlive the binding.
+    */
+    void bind(std::string attribute, const glCompute & source)
+    {
+        if (attributes.find(attribute) == attributes.end())
         {
-            if (fragmentNoUniforms)
-            {
-                return true;
-            }
+            throw std::runtime_error("No attribute: "+attribute);
         }
-
-        std::vector<std::string> toCheck {vertex, fragment};
-
-        for (unsigned i = 0; i < toCheck.size(); i++)
+        Attribute & attr = attributes[attribute];
+        if
+        (
+            attr.format != source.targetFormat ||
+            attr.dimX != source.targetSize.first ||
+            attr.dimY != source.targetSize.second
+        )
         {
-            std::string code = toCheck[i];
-
-            detectUniformsAndCreate<int>(code);
-            detectUniformsAndCreate<float>(code);
-            detectUniformsAndCreate<glm::vec2>(code);
-            detectUniformsAndCreate<glm::vec4>(code);
-            detectUniformsAndCreate<glm::mat4>(code);
-            detectUniformsAndCreate<Sampler2D>(code);
+            throw std::runtime_error("bind: attribute "+attribute+" does not match the source's output");
         }
-
-        return true;
-
+        if (!attr.pack.empty() || attr.tiled || source.tiles.size() > 1)
+        {
+            throw std::runtime_error("bind: attribute "+attribute+" or the source's output is packed or tiled");
+        }
+        attr.source = &source;
     }
 
-    template <class T>
-    void detectUniformsAndCreate(std::string code)
+    // sample the attribute's own texture again
+    void unbind(std::string attribute)
     {
-        const std::regex r = UNIFORM_DATA_REGEX<T>;
+        if (attributes.find(attribute) != attributes.end())
+        {
+            attributes[attribute].source = nullptr;
+        }
+    }
 
-        auto start = std::sregex_iterator(code.begin(), code.end(), r);
-        auto end = std::sregex_iterator();
-        for (std::sregex_iterator it = start; it != end; it++)
+    /*
+        Reduce the current output on the gpu, reading back one value per
+         tile. Needs an R32F output without vectorOutput.
+    */
+    float reduce(glReduction op)
+    {
+        if (targetFormat != glFormat::R32F)
+        {
+            throw std::runtime_error("reduce: the output is not R32F");
+        }
+        if (reducer == nullptr)
+        {
+            reducer = std::make_unique<glReducer>();
+        }
+        uint64_t length = outputLength == 0 ? targetSize.first*targetSize.second : outputLength;
+        float value = op == glReduction::Min ? INFINITY : op == glReduction::Max ? -INFINITY : 0.0f;
+        for (uint64_t i = 0; i < tiles.size(); i++)
         {
-            std::string match = (*it).str();
-            if (match.find("lowp") != std::string::npos)
+            const Tile & tile = tiles[i];
+            // 1D padding is at the end, so a tile's valid texels are a prefix
+            //  when tiles span whole rows
+            uint64_t start = tile.y*targetSize.first+tile.x;
+            if (start >= length)
             {
-                // uniform lowp TYPE NAME;
-                match.erase(0, match.find("lowp")+4);
-                // " TYPE NAME;"
+                continue;
             }
-            if (match.find("highp") != std::string::npos)
+            if (outputLength != 0 && tile.width != targetSize.first)
             {
-                // uniform highp TYPE NAME;
-                match.erase(0, match.find("highp")+5);
-                // " TYPE NAME;"
+                throw std::runtime_error("reduce: a 1D output split into columns of tiles");
             }
-            // found "uniform TYPE NAME;" or " TYPE NAME;"
-            match.erase(0, match.find(" ")+1);
-            match.erase(0, match.find(" ")+1);
-            std::string name = match.substr(0, match.find(";"));
-            std::shared_ptr<Uniform<T>> u = std::make_shared<Uniform<T>>(Uniform<T>(name,T(0)));
-            uniforms[name] = u;
+            glReduction tileOp = op == glReduction::Mean ? glReduction::Sum : op;
+            float v = reducer->reduce(outputTextures[i], tile.width, tile.height, tileOp, length-start);
+            value = op == glReduction::Min ? std::min(value, v) : op == glReduction::Max ? std::max(value, v) : value+v;
         }
-
+        return op == glReduction::Mean ? value/float(length) : value;
     }
 
-    // cannot have spec in class scope https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85282
-    //  also cannot use partial spec workaround because non-class, non-variable partial
-    //  specialization is not allowed
-    //  https://stackoverflow.com/questions/8061456/c-function-template-partial-specialization
-    // so the template dispatches to these guys
-
-    virtual void setValue(Uniform<int> * u, int value)
+    /*
+        Count the current output's values in bins equal bins of [lo, hi)
+         on the gpu, reading back bins values per tile. Needs an R32F
+         output without vectorOutput.
+    */
+    std::vector<float> histogram(float lo, float hi, uint64_t bins)
     {
-        u->value = value;
-
+        if (targetFormat != glFormat::R32F)
+        {
+            throw std::runtime_error("histogram: the output is not R32F");
+        }
+        if (scatterer == nullptr)
+        {
+            scatterer = std::make_unique<glScatter>();
+        }
+        uint64_t length = outputLength == 0 ? targetSize.first*targetSize.second : outputLength;
+        std::vector<float> counts(bins, 0.0f);
+        for (uint64_t i = 0; i < tiles.size(); i++)
+        {
+            const Tile & tile = tiles[i];
+            uint64_t start = tile.y*targetSize.first+tile.x;
+            if (start >= length)
+            {
+                continue;
+            }
+            if (outputLength != 0 && tile.width != targetSize.first)
+            {
+                throw std::runtime_error("histogram: a 1D output split into columns of tiles");
+            }
+            uint64_t elements = std::min(tile.width*tile.height, length-start);
+            std::vector<float> tileCounts = scatterer->histogram(outputTextures[i], tile.width, elements, lo, hi, bins);
+            for (uint64_t b = 0; b < bins; b++)
+            {
+                counts[b] += tileCounts[b];
+            }
+        }
+        return counts;
     }
 
-    virtual void setValue(Uniform<Sampler2D> * u, Sampler2D value)
+    /*
+        Replace the current output by its prefix sums, on the gpu, in
+         row by row order or within each row with rows. Needs an untiled
+         R32F output without vectorOutput.
+    */
+    void scan(bool inclusive = true, bool rows = false)
     {
-        u->value = value;
+        if (targetFormat != glFormat::R32F || tiles.size() > 1)
+        {
+            throw std::runtime_error("scan: the output is not R32F or is tiled");
+        }
+        if (scanner == nullptr)
+        {
+            scanner = std::make_unique<glScanner>();
+        }
+        scanner->scan(outputTextures[0], targetSize.first, targetSize.second, inclusive, rows);
     }
 
-    virtual void setValue(Uniform<float> * u, float value)
+    /*
+        Sort the current output (R32F or R32UI keys, untiled, without
+         vectorOutput) ascending on the gpu, applying the same permutation
+         to the textures of the payload attributes, which must match the
+         output's size. Payloads are only permuted on the gpu, their host
+         copies are unchanged.
+    */
+    void sort(std::vector<std::string> payloads = {})
     {
-        u->value = value;
+        if (tiles.size() > 1 || vectorOutput)
+        {
+            throw std::runtime_error("sort: the output is tiled or vectorOutput");
+        }
+        std::vector<std::pair<GLuint, glFormat>> textures;
+        for (const auto & name : payloads)
+        {
+            if (attributes.find(name) == attributes.end())
+            {
+                throw std::runtime_error("No attribute: "+name);
+            }
+            Attribute & attr = attributes[name];
+            if
+            (
+                attr.dimX != targetSize.first ||
+                attr.dimY != targetSize.second ||
+                !attr.pack.empty() ||
+                attr.source != nullptr ||
+                feedback == name
+            )
+            {
+                throw std::runtime_error("sort: payload "+name+" does not match the output");
+            }
+            textures.push_back({attr.texture, attr.format});
+        }
+        if (sorter == nullptr)
+        {
+            sorter = std::make_unique<glSorter>();
+        }
+        sorter->sort
+        (
+            outputTextures[0],
+            targetSize.first,
+            targetSize.second,
+            targetFormat,
+            textures,
+            outputLength
+        );
     }
 
-    virtual void setValue(Uniform<glm::vec2> * u, glm::vec2 value)
+    // compute without waiting for the result, collect it from the ticket
+    glReadback computeAsync()
     {
-        u->value = value;
+        compute(false);
+        return readback();
     }
 
-    virtual void setValue(Uniform<glm::vec4> * u, glm::vec4 value)
+    // start copying the current output into a pixel pack buffer
+    glReadback readback()
     {
-        u->value = value;
+        glFormatInfo info = formatInfo(targetFormat);
+        uint64_t bytes = targetSize.first*targetSize.second*info.texelBytes();
+        if (packBuffers == nullptr || packBuffers->size() != bytes)
+        {
+            packBuffers = std::make_shared<glPackBufferPool>(bytes);
+        }
+        GLuint pbo = packBuffers->acquire();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+
+        // with a pack buffer bound the data pointer is an offset into it
+        readOutput(nullptr);
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        return glReadback
+        (
+            pbo,
+            fence,
+            targetSize.first,
+            targetSize.second,
+            targetFormat,
+            padded() ? outputSize.first : 0,
+            outputElements(),
+            packBuffers
+        );
     }
 
-    virtual void setValue(Uniform<glm::mat4> * u, glm::mat4 value)
+private:
+
+    struct Attribute
     {
-        u->value = value;
-    }
-};
+        Attribute() = default;
 
-struct glShader : public Shader
-{
+        // without host data the attribute's data lives in mapped staging
+        Attribute
+        (
+            glFormat format,
+            GLuint texture,
+            uint64_t dimX,
+            uint64_t dimY,
+            bool mappedHost
+        )
+        : data(makeHostVector(format, mappedHost ? 0 : dimX*dimY*formatInfo(format).channels)),
+          format(format), texture(texture), dimX(dimX), dimY(dimY),
+          dirtyRows(dimY, 1), dirty(true)
+        {}
 
-    glShader(const char * v, const char * f)
-    : Shader(v, f), program(0), compiled(false), used(false)
-    {}
+        HostVector data;
+        glFormat format = glFormat::R32F;
+        GLuint texture;
+        uint64_t dimX;
+        uint64_t dimY;
 
-    glShader()
-    : Shader(), program(0), compiled(false), used(false)
-    {}
+        // rows changed on the host since the last sync
+        std::vector<uint8_t> dirtyRows;
+        bool dirty = false;
 
-    glShader(std::string path, std::string name)
-    : Shader(path, name), program(0), compiled(false), used(false)
-    {}
+        std::vector<GLuint> pixelBuffers;
+        uint8_t pixelBuffer = 0;
 
-    ~glShader(){if(isProgram()){release();}}
+        // packChannels, the pack this attribute is a channel of
+        std::string pack = "";
+        uint8_t channel = 0;
 
-    void create()
-    {
-        if (!isProgram())
+        // split into a texture per output tile
+        bool tiled = false;
+        std::vector<GLuint> tiles;
+
+        // what texture() samples outside the attribute
+        glBoundary boundary = glBoundary::Clamp;
+        float boundaryConstant = 0.0f;
+
+        // a 1D attribute's length, its layout may be padded
+        uint64_t length = 0;
+
+        // another glCompute whose output is sampled instead, see bind
+        const glCompute * source = nullptr;
+
+        // Transfer::Persistent, the host data lives in mapped staging memory
+        GLuint staging = 0;
+        void * mapped = nullptr;
+        GLsync fence = nullptr;
+
+        uint64_t channels() const { return formatInfo(format).channels; }
+        // elements in one row of texels, and in total
+        uint64_t rowElements() const { return dimX*channels(); }
+        uint64_t size() const { return dimY*rowElements(); }
+        // without a 1D attribute's padding
+        uint64_t elements() const { return length == 0 ? size() : length*channels(); }
+        uint64_t bytes() const { return dimX*dimY*formatInfo(format).texelBytes(); }
+
+        // the host data, waiting for the gpu to finish any copy from it
+        void * host()
         {
-            program = glCreateProgram();
-            compiled = false;
+            if (mapped == nullptr)
+            {
+                return hostData(data);
+            }
+            if (fence != nullptr)
+            {
+                waitFence(fence);
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+            return mapped;
         }
-    }
 
-    void release()
-    {
-        if (isProgram())
+        template <class T>
+        T * hostAs()
         {
-            glDeleteProgram(program);
-            compiled = false;
+            if (!isHostType<T>(format))
+            {
+                throw std::runtime_error("element type does not match the attribute's format");
+            }
+            return static_cast<T*>(host());
         }
-    }
 
-    void compile()
-    {
-        if (!isProgram())
+        // mark the rows holding elements [begin, end) for upload
+        void markDirty(uint64_t begin, uint64_t end)
         {
-            create();
+            if (end <= begin) { return; }
+            std::fill
+            (
+                dirtyRows.begin()+begin/rowElements(),
+                dirtyRows.begin()+(end-1)/rowElements()+1,
+                1
+            );
+            dirty = true;
         }
 
-        parseUniforms();
-
-        compileShader(program,vertex.c_str(),fragment.c_str());
-        compiled = true;
+        void clean()
+        {
+            std::fill(dirtyRows.begin(), dirtyRows.end(), 0);
+            dirty = false;
+        }
 
-        for (auto uniform = uniforms.cbegin(); uniform != uniforms.cend(); uniform++)
+        // runs of consecutive dirty rows as {first row, number of rows}
+        std::vector<std::pair<uint64_t, uint64_t>> dirtySpans() const
         {
-            AbstractUniform * u = (*uniform).second.get();
+            std::vector<std::pair<uint64_t, uint64_t>> spans;
+            uint64_t row = 0;
+            while (row < dimY)
+            {
+                if (dirtyRows[row] == 0) { row++; continue; }
+                uint64_t first = row;
+                while (row < dimY && dirtyRows[row] != 0) { row++; }
+                spans.push_back({first, row-first});
+            }
+            return spans;
+        }
+    };
 
-            Uniform<int> * ui = dynamic_cast<Uniform<int>*>(u);
-            if (ui != nullptr){ setValue(ui, 0); continue; }
+    // a region of the render target drawn in one pass
+    struct Tile
+    {
+        uint64_t x, y, width, height;
+    };
 
-            Uniform<float> * uf = dynamic_cast<Uniform<float>*>(u);
-            if (uf != nullptr){ setValue(uf, 0.0f); continue; }
+    std::vector<GLuint> textures;
+    std::map<std::string, Attribute> attributes;
+    // RGBA32F textures holding packed attributes
+    std::map<std::string, Attribute> packs;
 
-            Uniform<glm::vec2> * uv = dynamic_cast<Uniform<glm::vec2>*>(u);
-            if (uv != nullptr){ setValue(uv, glm::vec2(0.0f)); continue; }
+    HostVector output;
+    std::pair<uint64_t, uint64_t> outputSize;
+    glFormat outputFormat;
+    // the render target, differing from the output with vectorOutput
+    bool vectorOutput;
+    std::pair<uint64_t, uint64_t> targetSize;
+    glFormat targetFormat;
+    std::vector<Tile> tiles;
+    std::vector<GLuint> outputTextures;
+    // of a 1D output
+    uint64_t outputLength = 0;
+    // the attribute to swap textures with the output before computing
+    std::string feedback = "";
+    std::unique_ptr<glReducer> reducer;
+    std::unique_ptr<glScatter> scatterer;
+    std::unique_ptr<glScanner> scanner;
+    std::unique_ptr<glSorter> sorter;
+    Transfer transfer;
+    GLuint frameBuffer, vao, vbo;
 
-            Uniform<glm::mat4> * um = dynamic_cast<Uniform<glm::mat4>*>(u);
-            if (um != nullptr){ setValue(um, glm::mat4(0.0f)); continue; }
+    // Transfer::Persistent, the result lands in mapped pack buffer memory
+    GLuint outputBuffer = 0;
+    void * outputMapped = nullptr;
+    GLsync outputFence = nullptr;
+
+    // readback() tickets' pack buffers, returned as tickets are read
+    std::shared_ptr<glPackBufferPool> packBuffers;
+
+    // give attr a texture, and staging for the transfer mode
+    void initAttribute(Attribute & attr)
+    {
+        if (attr.tiled)
+        {
+            attr.tiles.resize(tiles.size());
+            glGenTextures(tiles.size(), attr.tiles.data());
+            for (uint64_t i = 0; i < tiles.size(); i++)
+            {
+                textures.push_back(attr.tiles[i]);
+                initTexture2D(attr.tiles[i], tiles[i].width, tiles[i].height, attr.format);
+            }
+        }
+        else
+        {
+            glGenTextures(1, &attr.texture);
+            textures.push_back(attr.texture);
+            initTexture2D(attr.texture, attr.dimX, attr.dimY, attr.format);
+            if (attr.boundary != glBoundary::Clamp)
+            {
+                setTextureBoundary2D(attr.texture, attr.boundary, attr.boundaryConstant);
+            }
+        }
+        if (transfer == Transfer::Persistent)
+        {
+            attr.data = makeHostVector(attr.format, 0);
+            glGenBuffers(1, &attr.staging);
+            // get() and the pack paths read the host data back through this
+            attr.mapped = initPersistentBuffer
+            (
+                GL_PIXEL_UNPACK_BUFFER,
+                attr.staging,
+                attr.bytes(),
+                GL_MAP_READ_BIT | GL_MAP_WRITE_BIT
+            );
+            if (attr.mapped == nullptr)
+            {
+                throw GLRuntimeException("glCompute: could not map an attribute's persistent staging buffer");
+            }
+            std::memset(attr.mapped, 0, attr.bytes());
+        }
+        else if (transfer == Transfer::PixelBuffer)
+        {
+            attr.pixelBuffers.resize(PIXEL_BUFFER_RING);
+            glGenBuffers(PIXEL_BUFFER_RING, attr.pixelBuffers.data());
+            for (GLuint pbo : attr.pixelBuffers)
+            {
+                initPixelBuffer(pbo, attr.bytes());
+            }
         }
     }
 
-    void use()
+    void syncAttribute(Attribute & attr)
     {
-        if (!compiled){compile();}
-        glUseProgram(program);
+        if (!attr.dirty || attr.source != nullptr)
+        {
+            return;
+        }
+        settleFeedback(attr);
+        auto spans = attr.dirtySpans();
+        if (transfer == Transfer::Persistent)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, attr.staging);
+            if (attr.tiled)
+            {
+                transferSpansToTiles(attr, nullptr, spans);
+            }
+            else
+            {
+                transferRowsFromPixelBuffer(attr.texture, attr.dimX, spans, attr.format);
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            if (attr.fence != nullptr) { glDeleteSync(attr.fence); }
+            attr.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        else if (transfer == Transfer::PixelBuffer)
+        {
+            // cycle the ring so we never write a buffer the gpu may
+            //  still be copying from
+            GLuint pbo = attr.pixelBuffers[attr.pixelBuffer];
+            attr.pixelBuffer = (attr.pixelBuffer+1) % attr.pixelBuffers.size();
+            if (attr.tiled)
+            {
+                stageRowsInPixelBuffer(pbo, attr.host(), attr.dimX, attr.dimY, spans, attr.format);
+                transferSpansToTiles(attr, nullptr, spans);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            else
+            {
+                transferRowsToTexture2D(attr.texture, pbo, attr.host(), attr.dimX, attr.dimY, spans, attr.format);
+            }
+        }
+        else if (attr.tiled)
+        {
+            transferSpansToTiles(attr, attr.host(), spans);
+        }
+        else
+        {
+            for (const auto & span : spans)
+            {
+                transferRowsToTexture2D(attr.texture, attr.host(), attr.dimX, span.first, span.second, attr.format);
+            }
+        }
+        attr.clean();
     }
 
-    bool isCompiled(){return compiled;}
-    bool isProgram(){return glIsProgram(program);}
+    // upload the spans of rows from data, or offsets into a bound unpack
+    //  buffer, to each of attr's tiles they cross
+    void transferSpansToTiles
+    (
+        Attribute & attr,
+        const void * data,
+        const std::vector<std::pair<uint64_t, uint64_t>> & spans
+    )
+    {
+        for (const auto & span : spans)
+        {
+            for (uint64_t i = 0; i < tiles.size(); i++)
+            {
+                const Tile & tile = tiles[i];
+                uint64_t begin = std::max(span.first, tile.y);
+                uint64_t end = std::min(span.first+span.second, tile.y+tile.height);
+                if (begin < end)
+                {
+                    transferTileRowsToTexture2D
+                    (
+                        attr.tiles[i],
+                        data,
+                        attr.dimX,
+                        tile.x,
+                        tile.y,
+                        tile.width,
+                        begin,
+                        end-begin,
+                        attr.format
+                    );
+                }
+            }
+        }
+    }
 
-private:
+    // interleave the dirty rows of a pack's attributes then sync it
+    void syncPack(const std::string & name)
+    {
+        Attribute & pack = packs[name];
+        float * packed = nullptr;
+        for (auto & attr : attributes)
+        {
+            Attribute & a = attr.second;
+            if (a.pack != name || !a.dirty)
+            {
+                continue;
+            }
+            if (packed == nullptr)
+            {
+                packed = pack.template hostAs<float>();
+            }
+            const float * host = a.template hostAs<float>();
+            for (const auto & span : a.dirtySpans())
+            {
+                for (uint64_t i = span.first*a.dimX; i < (span.first+span.second)*a.dimX; i++)
+                {
+                    packed[i*4+a.channel] = host[i];
+                }
+                pack.markDirty(span.first*pack.rowElements(), (span.first+span.second)*pack.rowElements());
+            }
+            a.clean();
+        }
+        syncAttribute(pack);
+    }
 
-    GLuint program;
-    bool compiled;
-    bool used;
+    /*
+        The fragment shader as compiled
+
+        Packed attributes' declarations are replaced by their pack's
+         sampler and accessors, and a sampler of the matching type is
+         declared for each attribute the shader does not declare itself,
+         as are the tile uniforms.
+    */
+    std::string generateSource(std::string fragment)
+    {
+        std::string declarations = "";
+        std::unordered_set<std::string> declared = glslUniformNames(fragment);
+        for (std::string uniform : {"glc_tileOffset", "glc_tileSize", "glc_size"})
+        {
+            if (declared.count(uniform) == 0)
+            {
+                declarations += "uniform vec2 "+uniform+";\n";
+            }
+        }
+        for (const auto & pack : packs)
+        {
+            declarations += "uniform highp sampler2D "+pack.first+";\n";
+        }
+        const char * channels = "rgba";
+        for (const auto & attr : attributes)
+        {
+            const std::string & name = attr.first;
+            if (!attr.second.pack.empty())
+            {
+                const std::string & pack = attr.second.pack;
+                std::string channel(1, channels[attr.second.channel]);
+                fragment = std::regex_replace
+                (
+                    fragment,
+                    std::regex("uniform\\s+(\\w+\\s+)*sampler2D\\s+"+name+"\\s*;"),
+                    ""
+                );
+                fragment = std::regex_replace
+                (
+                    fragment,
+                    std::regex("\\btexture\\s*\\(\\s*"+name+"\\s*,"),
+                    "glc_texture_"+name+"("
+                );
+                fragment = std::regex_replace
+                (
+                    fragment,
+                    std::regex("\\btexelFetch\\s*\\(\\s*"+name+"\\s*,"),
+                    "glc_texelFetch_"+name+"("
+                );
+                fragment = std::regex_replace
+                (
+                    fragment,
+                    std::regex("\\btextureSize\\s*\\(\\s*"+name+"\\s*,"),
+                    "textureSize("+pack+","
+                );
+                // the 1D helper element(x, i)
+                fragment = std::regex_replace
+                (
+                    fragment,
+                    std::regex("\\belement\\s*\\(\\s*"+name+"\\s*,"),
+                    "glc_element_"+name+"("
+                );
+                declarations +=
+                    "vec4 glc_texture_"+name+"(vec2 uv){ return vec4(texture("+pack+", uv)."+channel+", 0.0, 0.0, 1.0); }\n"
+                    "vec4 glc_texelFetch_"+name+"(ivec2 p, int lod){ return vec4(texelFetch("+pack+", p, lod)."+channel+", 0.0, 0.0, 1.0); }\n"
+                    "vec4 glc_element_"+name+"(int i){ int w = textureSize("+pack+", 0).x; "
+                    "return vec4(texelFetch("+pack+", ivec2(i % w, i / w), 0)."+channel+", 0.0, 0.0, 1.0); }\n";
+                continue;
+            }
+            if (declared.count(name) == 0)
+            {
+                declarations = "uniform highp "
+                    + std::string(formatInfo(attr.second.format).sampler)
+                    + " "+name+";\n" + declarations;
+            }
+        }
+        if (vectorOutput)
+        {
+            fragment += vectorMain();
+        }
+        // es has no default float precision in fragment shaders
+        return insertAfterVersion(fragment, "precision highp float;\nprecision highp int;\n"+declarations);
+    }
 
-    inline const GLuint location(const char * name) const
+    // main for vectorOutput, four lanes of kernel per fragment
+    std::string vectorMain()
     {
-        return glGetUniformLocation(program, name);
+        std::string n = std::to_string(outputSize.first);
+        std::string m = std::to_string(outputSize.second);
+        std::string source =
+            "\nlayout(location = 0) out vec4 glc_value;\n"
+            "float glc_lane(ivec2 element)\n"
+            "{\n"
+            "    if (element.x >= "+n+") { return 0.0; }\n"
+            "    return kernel(element, (vec2(element)+0.5)/vec2("+n+".0, "+m+".0));\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "    ivec2 p = ivec2(gl_FragCoord.xy);\n"
+            "    ivec2 e = ivec2(p.x*4, p.y);\n"
+            "    glc_value = vec4\n"
+            "    (\n"
+            "        glc_lane(e),\n"
+            "        glc_lane(e+ivec2(1, 0)),\n"
+            "        glc_lane(e+ivec2(2, 0)),\n"
+            "        glc_lane(e+ivec2(3, 0))\n"
+            "    );\n"
+            "}\n";
+        return source;
     }
 
-    // cannot have spec in class scope https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85282
-    //  also cannot use partial spec workaround because non-class, non-variable partial
-    //  specialization is not allowed
-    //  https://stackoverflow.com/questions/8061456/c-function-template-partial-specialization
-    // so the template dispatches to these guys
+    // give attr the output of an iterate step pending for it, so uploads
+    //  go to the texture it will be read from
+    void settleFeedback(Attribute & attr)
+    {
+        if (!feedback.empty() && &attributes[feedback] == &attr)
+        {
+            swapOutput(attr);
+            feedback.clear();
+        }
+    }
 
-    void setValue(Uniform<int> * u, int value)
+    void swapOutput(Attribute & attr)
     {
-        u->value = value;
-        if (isCompiled())
+        if (attr.tiled)
         {
-            use();
-            glUniform1i(location(u->name.c_str()), u->value);
+            std::swap(attr.tiles, outputTextures);
+        }
+        else
+        {
+            std::swap(attr.texture, outputTextures[0]);
+            // the boundary belongs to the attribute, not the texture
+            if (attr.boundary != glBoundary::Clamp)
+            {
+                setTextureBoundary2D(attr.texture, attr.boundary, attr.boundaryConstant);
+                setTextureBoundary2D(outputTextures[0], glBoundary::Clamp);
+            }
         }
+    }
 
+    uint64_t outputElements() const
+    {
+        uint64_t texels = outputLength == 0 ? outputSize.first*outputSize.second : outputLength;
+        return texels*formatInfo(outputFormat).channels;
     }
 
-    void setValue(Uniform<Sampler2D> * u, Sampler2D value)
+    static std::map<std::string, std::pair<uint64_t, uint64_t>> linearLayouts
+    (
+        const std::map<std::string, uint64_t> & lengths
+    )
     {
-        u->value = value;
-        if (isCompiled())
+        std::map<std::string, std::pair<uint64_t, uint64_t>> layouts;
+        for (auto & length : lengths)
         {
-            use();
-            glUniform1i(location(u->name.c_str()), u->value.texture);
+            layouts[length.first] = linearLayout(length.second);
         }
-
+        return layouts;
     }
 
-    void setValue(Uniform<float> * u, float value)
+    // fragment with the 1D helpers, width being the output layout's
+    static std::string linearSource(const char * fragment, uint64_t width)
     {
-        u->value = value;
-        if (isCompiled())
+        std::string n = std::to_string(width);
+        std::string helpers =
+            "int index(ivec2 element){ return element.y*"+n+"+element.x; }\n"
+            "int index(){ return index(ivec2(glc_tileOffset+gl_FragCoord.xy)); }\n";
+        for (std::string prefix : {"", "i", "u"})
         {
-            use();
-            glUniform1f(location(u->name.c_str()), u->value);
+            std::string sampler = prefix+"sampler2D";
+            helpers +=
+                prefix+"vec4 element(highp "+sampler+" s, int i)"
+                "{ int w = textureSize(s, 0).x; return texelFetch(s, ivec2(i % w, i / w), 0); }\n";
         }
+        return insertAfterVersion(fragment, helpers);
+    }
 
+    // vectorOutput with n not a multiple of 4 pads each row
+    bool padded() const
+    {
+        return vectorOutput && targetSize.first*4 != outputSize.first;
     }
 
-    void setValue(Uniform<glm::vec2> * u, glm::vec2 value)
+    // drop the padding lanes of each row from source into the output
+    void unpackOutput(const void * source)
     {
-        u->value = value;
-        if (isCompiled())
+        uint64_t n = outputSize.first;
+        uint64_t width = targetSize.first*4;
+        std::vector<float> & host = std::get<std::vector<float>>(output);
+        if (host.size() < n*outputSize.second)
         {
-            use();
-            glUniform2f(location(u->name.c_str()), u->value.x, u->value.y);
+            host.resize(n*outputSize.second);
+        }
+        const float * from = static_cast<const float*>(source);
+        // rows only move down, so this is safe in place
+        for (uint64_t row = 0; row < outputSize.second; row++)
+        {
+            std::memmove(host.data()+row*n, from+row*width, n*sizeof(float));
         }
-
     }
 
-    void setValue(Uniform<glm::vec4> * u, glm::vec4 value)
+    /*
+        Read each output tile into its place in the targetSize array at
+         destination, an offset when a pack buffer is bound. Leaves the
+         frame buffer bound.
+    */
+    void readOutput(void * destination)
     {
-        u->value = value;
-        if (isCompiled())
+        glFormatInfo info = formatInfo(targetFormat);
+        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_PACK_ROW_LENGTH, targetSize.first);
+        for (uint64_t i = 0; i < tiles.size(); i++)
         {
-            use();
-            glUniform4f(location(u->name.c_str()), u->value.x, u->value.y, u->value.z, u->value.w);
+            const Tile & tile = tiles[i];
+            glFramebufferTexture2D
+            (
+                GL_FRAMEBUFFER,
+                GL_COLOR_ATTACHMENT0,
+                GL_TEXTURE_2D,
+                outputTextures[i],
+                0
+            );
+            glReadPixels
+            (
+                0,
+                0,
+                tile.width,
+                tile.height,
+                info.format,
+                info.type,
+                reinterpret_cast<uint8_t*>(destination)+(tile.y*targetSize.first+tile.x)*info.texelBytes()
+            );
         }
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    }
 
+    // read the output into the mapped result, fenced
+    void readPersistent()
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, outputBuffer);
+        readOutput(nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (outputFence != nullptr) { glDeleteSync(outputFence); }
+        outputFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
 
-    void setValue(Uniform<glm::mat4> * u, glm::mat4 value)
+    void releasePersistent(GLenum target, GLuint buffer, GLsync fence)
     {
-        u->value = value;
-        if (isCompiled())
+        if (fence != nullptr)
         {
-            use();
-            glUniformMatrix4fv(location(u->name.c_str()), 1, false, glm::value_ptr(u->value));
+            glDeleteSync(fence);
+        }
+        if (buffer != 0)
+        {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            glBindBuffer(target, 0);
+            glDeleteBuffers(1, &buffer);
         }
     }
 
+    float quad[6*4] =
+    {
+        -1.0, -1.0, 0.0, 0.0,
+         1.0, -1.0, 1.0, 0.0,
+         1.0,  1.0, 1.0, 1.0,
+        -1.0, -1.0, 0.0, 0.0,
+        -1.0,  1.0, 0.0, 1.0,
+         1.0,  1.0, 1.0, 1.0
+    };
 };
 
-class glCompute
+/*
+    A CSR sparse matrix on the gpu for y = A x. Row pointers are an R32UI
+     texture and each non-zero is one RG32UI texel holding its column and
+     its value's bits, so the kernel makes a single texelFetch per
+     non-zero plus one for x. All arrays use the 1D near-square layout,
+     so up to GL_MAX_TEXTURE_SIZE^2 non-zeros fit.
+
+    x is the attribute "x", it can be set on compute() or bound to
+     another glCompute's output (see glCompute::bind), and y is the
+     output.
+*/
+class glSparseMatrix
 {
 
 public:
 
-    glShader shader;
-
-    const char * vertexShader =
-        "#version " GLSL_VERSION "\n"
-        "precision highp float;\n"
-        "precision highp int;\n"
-        "layout(location = 0) in vec4 a_position;\n"
-        "out vec2 o_texCoords;\n"
-        "void main(){\n"
-        "   gl_Position = vec4(a_position.xy,0.0,1.0);\n"
-        "   o_texCoords = a_position.zw;\n"
-        "}";
-
-    glCompute
+    // rowPointers has rows+1 entries, row i's non-zeros being
+    //  [rowPointers[i], rowPointers[i+1]) of columnIndices and values
+    glSparseMatrix
     (
-        std::map<std::string, std::pair<uint64_t, uint64_t>> attributeSize,
-        std::pair<uint64_t, uint64_t> outputSize,
-        const char * fragmentShader
+        uint64_t rows,
+        uint64_t columns,
+        const std::vector<uint32_t> & rowPointers,
+        const std::vector<uint32_t> & columnIndices,
+        const std::vector<float> & values,
+        glCompute::Options options = glCompute::Options()
     )
-    : outputSize(outputSize)
-    {
-        shader = glShader(vertexShader, fragmentShader);
-        shader.compile();
-        uint64_t n = attributeSize.size();
-        textures.resize(n+1);
-        glGenTextures(n+1, textures.data());
-        uint64_t t = 0;
-        for (auto & attr : attributeSize)
+    : rows(rows), columns(columns)
+    {
+        if (rowPointers.size() != rows+1 || columnIndices.size() != values.size())
         {
-            attributes[attr.first] = Attribute
-            (
-                std::vector<float>(attr.second.first*attr.second.second, 0.0),
-                textures[t],
-                attr.second.first,
-                attr.second.second
-            );
-            initTexture2DR32F(textures[t], attr.second.first, attr.second.second);
-            t++;
+            throw std::runtime_error("glSparseMatrix: inconsistent CSR arrays");
         }
-        initTexture2DR32F(textures.back(), outputSize.first, outputSize.second);
-        output = std::vector<float>(outputSize.first*outputSize.second, 0.0);
-        transferToTexture2DR32F(textures.back(), output, outputSize.first, outputSize.second);
-        glGenFramebuffers(1, &frameBuffer);
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-        glGenBuffers(1, &vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData
-        (
-            GL_ARRAY_BUFFER,
-            sizeof(float)*6*4,
-            &quad[0],
-            GL_STATIC_DRAW
-        );
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer
+        uint64_t nonZeros = values.size();
+        spmv = std::make_unique<glCompute>
         (
-            0,
-            4,
-            GL_FLOAT,
-            false,
-            4*sizeof(float),
-            0
+            std::map<std::string, uint64_t>
+            {
+                {"glc_rows", rows+1},
+                {"glc_entries", std::max(nonZeros, uint64_t(1))},
+                {"x", columns}
+            },
+            std::map<std::string, glFormat>
+            {
+                {"glc_rows", glFormat::R32UI},
+                {"glc_entries", glFormat::RG32UI}
+            },
+            rows,
+            glFormat::R32F,
+            kernel(rows).c_str(),
+            options
         );
-        glVertexAttribDivisor(0,0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
+
+        spmv->set("glc_rows", rowPointers);
+        std::vector<uint32_t> entries(2*nonZeros);
+        for (uint64_t k = 0; k < nonZeros; k++)
+        {
+            entries[2*k] = columnIndices[k];
+            std::memcpy(&entries[2*k+1], &values[k], sizeof(float));
+        }
+        spmv->set("glc_entries", std::move(entries));
+        spmv->sync();
     }
 
-    ~glCompute()
+    // y = A x, x having columns elements
+    ArrayView<const float> multiply(const std::vector<float> & x)
     {
-        glDeleteTextures(attributes.size(), textures.data());
-        glDeleteFramebuffers(1, &frameBuffer);
-        glDeleteBuffers(1, &vbo);
-        glDeleteVertexArrays(1, &vao);
+        spmv->set("x", x);
+        spmv->sync("x");
+        spmv->compute(true);
+        return spmv->result();
     }
 
-    void set(std::string attribute, std::vector<float> newData)
+    // y = A x for the x already set or bound, y stays on the gpu
+    void multiply()
     {
-        if (attributes.find(attribute) != attributes.end())
-        {
-            if (newData.size() <= attributes[attribute].data.size())
-            {
-                std::copy
-                (
-                    newData.begin(),
-                    newData.end(),
-                    attributes[attribute].data.begin()
-                );
-            }
-        }
+        spmv->sync("x");
+        spmv->compute(false);
     }
 
-    void set(std::string attribute, float datum, uint64_t index)
+    // the underlying glCompute, for x, y and binding into pipelines
+    glCompute & compute() { return *spmv; }
+
+    uint64_t rows, columns;
+
+private:
+
+    std::unique_ptr<glCompute> spmv;
+
+    static std::string kernel(uint64_t rows)
     {
-        if (attributes.find(attribute) != attributes.end())
+        return
+            "#version " GLSL_VERSION "\n"
+            "precision highp float;\n"
+            "precision highp int;\n"
+            "uniform highp usampler2D glc_rows;\n"
+            "uniform highp usampler2D glc_entries;\n"
+            "uniform highp sampler2D x;\n"
+            "layout(location = 0) out float o_value;\n"
+            "void main(){\n"
+            "   int i = index();\n"
+            "   float y = 0.0;\n"
+            "   if (i < "+std::to_string(rows)+"){\n"
+            "       int begin = int(element(glc_rows, i).r);\n"
+            "       int end = int(element(glc_rows, i+1).r);\n"
+            "       for (int k = begin; k < end; k++){\n"
+            "           uvec2 entry = element(glc_entries, k).rg;\n"
+            "           y += uintBitsToFloat(entry.g)*element(x, int(entry.r)).r;\n"
+            "       }\n"
+            "   }\n"
+            "   o_value = y;\n"
+            "}";
+    }
+};
+
+/*
+    Chains glComputes (stages) on the gpu. A stage attribute named after
+     another stage samples that stage's output texture directly (see
+     glCompute::bind), so intermediates never visit the host. compute()
+     runs the stages in topological order.
+
+    Host attributes are set on the stages, e.g.
+
+        pipeline.stage("filter").set("signal", data);
+*/
+class glPipeline
+{
+
+public:
+
+    glCompute & add
+    (
+        std::string name,
+        std::map<std::string, std::pair<uint64_t, uint64_t>> attributeSize,
+        std::pair<uint64_t, uint64_t> outputSize,
+        const char * fragmentShader,
+        glCompute::Options options = glCompute::Options()
+    )
+    {
+        return add(name, attributeSize, {}, outputSize, glFormat::R32F, fragmentShader, options);
+    }
+
+    glCompute & add
+    (
+        std::string name,
+        std::map<std::string, std::pair<uint64_t, uint64_t>> attributeSize,
+        std::map<std::string, glFormat> attributeFormat,
+        std::pair<uint64_t, uint64_t> outputSize,
+        glFormat outputFormat,
+        const char * fragmentShader,
+        glCompute::Options options = glCompute::Options()
+    )
+    {
+        if (stages.find(name) != stages.end())
         {
-            if (index <= attributes[attribute].data.size())
-            {
-                attributes[attribute].data[index] = datum;
-            }
+            throw std::runtime_error("glPipeline: duplicate stage "+name);
+        }
+        stages[name] = std::make_unique<glCompute>
+        (
+            attributeSize,
+            attributeFormat,
+            outputSize,
+            outputFormat,
+            fragmentShader,
+            options
+        );
+        inputs[name] = {};
+        for (auto & attr : attributeSize)
+        {
+            inputs[name].push_back(attr.first);
         }
+        ordered = false;
+        return *stages[name];
     }
 
-    std::vector<float> & get(std::string attribute)
+    glCompute & stage(std::string name)
     {
-        if (attributes.find(attribute) != attributes.end())
+        if (stages.find(name) == stages.end())
         {
-            return attributes[attribute].data;
+            throw std::runtime_error("glPipeline: no stage "+name);
         }
-        throw std::runtime_error("No attribute: "+attribute);
+        return *stages[name];
     }
 
-    const std::vector<float> & result() { return output; }
-
-    void sync(std::string attribute)
+    // stages no other stage reads from
+    std::vector<std::string> outputs()
     {
-        if (attributes.find(attribute) != attributes.end())
+        std::vector<std::string> sinks;
+        for (const auto & name : order())
         {
-            Attribute & attr = attributes[attribute];
-            transferToTexture2DR32F(attr.texture, attr.data, attr.dimX, attr.dimY);
+            bool read = false;
+            for (const auto & stageInputs : inputs)
+            {
+                read = read || std::find(stageInputs.second.begin(), stageInputs.second.end(), name) != stageInputs.second.end();
+            }
+            if (!read)
+            {
+                sinks.push_back(name);
+            }
         }
+        return sinks;
     }
 
-    void sync()
+    // the stages in the order they run, inputs before their readers
+    const std::vector<std::string> & order()
     {
-        for (const auto & attr : attributes)
+        if (!ordered)
         {
-            sync(attr.first);
+            sort();
         }
+        return sequence;
     }
 
-    void compute(bool syncResult)
+    // run every stage, reading back the outputs() when syncResult
+    void compute(bool syncResult = false)
     {
-        shader.use();
-
-        glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures.back());
-
-        glFramebufferTexture2D
-        (
-            GL_FRAMEBUFFER,
-            GL_COLOR_ATTACHMENT0,
-            GL_TEXTURE_2D,
-            textures.back(),
-            0
-        );
-        GLenum drawBuffers[1] = {GL_COLOR_ATTACHMENT0};
-        glDrawBuffers(1, drawBuffers);
-
-        GLuint t = 0;
-        for (const auto & attr : attributes)
+        for (const auto & name : order())
         {
-            glActiveTexture(GL_TEXTURE0+t+2);
-            glBindTexture(GL_TEXTURE_2D, attr.second.texture);
-            shader.setUniform(attr.first, Sampler2D(t+2));
-            t++;
+            glCompute & s = *stages[name];
+            s.sync();
+            s.compute(false);
         }
-
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
-
-        glDepthMask(false);
-        glDisable(GL_BLEND);
-        glViewport(0, 0, outputSize.first, outputSize.second);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
         if (syncResult)
         {
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, textures.back());
-            glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, output.data());
+            for (const auto & name : outputs())
+            {
+                stages[name]->syncResult();
+            }
         }
-
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glBindVertexArray(0);
     }
 
-    const std::vector<float> & syncResult()
+    template <class T = float>
+    ArrayView<const T> result(std::string name)
     {
-        glReadBuffer(GL_COLOR_ATTACHMENT0);
-        glReadPixels
-        (
-            0,
-            0,
-            outputSize.first,
-            outputSize.second,
-            GL_RED,
-            GL_FLOAT,
-            output.data()
-        );
-        return result();
+        return stage(name).template result<T>();
     }
 
 private:
 
-    struct Attribute
-    {
-        Attribute() = default;
-
-        Attribute
-        (
-            std::vector<float> data,
-            GLuint texture,
-            uint64_t dimX,
-            uint64_t dimY
-        )
-        : data(data), texture(texture), dimX(dimX), dimY(dimY)
-        {}
+    std::map<std::string, std::unique_ptr<glCompute>> stages;
+    // each stage's attribute names
+    std::map<std::string, std::vector<std::string>> inputs;
+    std::vector<std::string> sequence;
+    bool ordered = false;
 
-        std::vector<float> data;
-        GLuint texture;
-        uint64_t dimX;
-        uint64_t dimY;
-    };
+    // Kahn's algorithm, binding stage inputs on the way
+    void sort()
+    {
+        std::map<std::string, uint64_t> pending;
+        for (const auto & stageInputs : inputs)
+        {
+            pending[stageInputs.first] = 0;
+            for (const auto & input : stageInputs.second)
+            {
+                if (stages.find(input) != stages.end())
+                {
+                    pending[stageInputs.first]++;
+                }
+            }
+        }
 
-    std::vector<GLuint> textures;
-    std::map<std::string, Attribute> attributes;
+        sequence.clear();
+        std::vector<std::string> ready;
+        for (const auto & p : pending)
+        {
+            if (p.second == 0) { ready.push_back(p.first); }
+        }
+        while (!ready.empty())
+        {
+            std::string name = ready.back();
+            ready.pop_back();
+            sequence.push_back(name);
+            for (const auto & stageInputs : inputs)
+            {
+                for (const auto & input : stageInputs.second)
+                {
+                    if (input == name && --pending[stageInputs.first] == 0)
+                    {
+                        ready.push_back(stageInputs.first);
+                    }
+                }
+            }
+        }
 
-    std::vector<float> output;
-    std::pair<uint64_t, uint64_t> outputSize;
-    GLuint frameBuffer, vao, vbo;
+        if (sequence.size() != stages.size())
+        {
+            sequence.clear();
+            throw std::runtime_error("glPipeline: the stages form a cycle");
+        }
 
-    float quad[6*4] =
-    {
-        -1.0, -1.0, 0.0, 0.0,
-         1.0, -1.0, 1.0, 0.0,
-         1.0,  1.0, 1.0, 1.0,
-        -1.0, -1.0, 0.0, 0.0,
-        -1.0,  1.0, 0.0, 1.0,
-         1.0,  1.0, 1.0, 1.0
-    };
+        // only an acyclic pipeline binds, and a bind that throws (a size,
+        //  format, pack or tile mismatch) undoes the ones made before it
+        std::vector<std::pair<std::string, std::string>> bound;
+        try
+        {
+            for (const auto & stageInputs : inputs)
+            {
+                for (const auto & input : stageInputs.second)
+                {
+                    if (stages.find(input) != stages.end())
+                    {
+                        stages[stageInputs.first]->bind(input, *stages[input]);
+                        bound.push_back({stageInputs.first, input});
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            for (const auto & b : bound)
+            {
+                stages[b.first]->unbind(b.second);
+            }
+            sequence.clear();
+            throw;
+        }
+        ordered = true;
+    }
 };
 #endif /* GLGPGPU_H */
@@ -18,7 +18,18 @@ const char * computeShader =
     "    output = texture(x, o_texCoords).r+texture(y, o_texCoords).r;\n"
     "}";
 
+// 1D arrays, x and y packed into one texture's channels
+const char * linearShader =
+    "#version " GLSL_VERSION "\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "layout(location=0) out float output;\n"
+    "void main(){\n"
+    "    output = element(x, index()).r+element(y, index()).r;\n"
+    "}";
+
 const int n = 16;
+const int length = 100;
 
 int main()
 {
@@ -60,6 +71,31 @@ int main()
     }
     std::cout << output[n*n-1] << "\n";
 
+    glCompute::Options options;
+    options.packChannels = true;
+    glCompute linear({{"x", length}, {"y", length}}, length, linearShader, options);
+
+    std::vector<float> a(length), b(length);
+    for (int i = 0; i < length; i++)
+    {
+        a[i] = float(i);
+        b[i] = float(2*i);
+    }
+    linear.set("x", a);
+    linear.set("y", b);
+    linear.sync();
+    linear.compute(true);
+    auto sum = linear.result();
+    for (int i = 0; i < length; i++)
+    {
+        if (sum[i] != a[i]+b[i])
+        {
+            std::cout << "packed 1D element " << i << ": " << sum[i] << " != " << a[i]+b[i] << "\n";
+            return 1;
+        }
+    }
+    std::cout << "packed 1D sum of " << length << " elements ok\n";
+
     glfwSwapBuffers(glfwWindow);
     glfwWindowShouldClose(glfwWindow);
 }
\ No newline at end of file